@@ -14,6 +14,16 @@
 
 using namespace m5::unit::types;
 
+namespace {
+// Standard I2C clocks tried by the negotiation, from the highest (Fast-mode Plus, Fast-mode)
+constexpr uint32_t negotiation_clocks[] = {1000000U, 400000U};
+// Number of consecutive successful verifications required to settle on a clock
+constexpr uint32_t negotiation_verify_times{4};
+// Runtime error monitoring of the negotiated clock
+constexpr uint16_t clock_monitor_window{32};          // Transactions per window
+constexpr uint16_t clock_monitor_error_threshold{3};  // Errors in a window that cause a step down
+}  // namespace
+
 namespace m5 {
 namespace unit {
 
@@ -246,12 +256,12 @@ bool Component::assign(const uart_port_t uart_num)
     return false;
 }
 
-bool Component::assign(spi_device_handle_t handle, const gpio_num_t cs)
+bool Component::assign(spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs)
 {
     if (canAccessSPI()) {
         // If cs is omitted (GPIO_NUM_NC), use address() as the CS pin (same convention as Arduino SPI).
         const gpio_num_t actual_cs = (cs == GPIO_NUM_NC) ? static_cast<gpio_num_t>(address()) : cs;
-        _adapter                   = std::make_shared<AdapterSPI>(handle, actual_cs);
+        _adapter                   = std::make_shared<AdapterSPI>(handle, actual_cs, hardware_cs);
         return static_cast<bool>(_adapter);
     }
     return false;
@@ -267,17 +277,141 @@ bool Component::selectChannel(const uint8_t ch)
     return ret && (select_channel(ch) == m5::hal::error::error_t::OK);
 }
 
+m5::hal::error::error_t Component::executeTransaction(const TransactionBuilder& tb)
+{
+    if (tb.empty()) {
+        return m5::hal::error::error_t::OK;
+    }
+    // The channel is selected under the bus lock so that the other task does not switch it in between
+    bus_lock_guard lock(adapter()->busLock());
+    selectChannel(channel());
+    auto r = adapter()->executeTransaction(tb.data(), tb.size());
+    monitor_clock(r);
+    return r;
+}
+
+bool Component::negotiateClock()
+{
+    auto ad = asAdapter<AdapterI2C>(Adapter::Type::I2C);
+    if (!ad) {
+        M5_LIB_LOGE("Not I2C");
+        return false;
+    }
+
+    _clock_negotiated = false;
+    for (auto&& clk : negotiation_clocks) {
+        if (clk > _component_cfg.max_clock || clk <= _component_cfg.clock) {
+            continue;
+        }
+        ad->setClock(clk);
+        uint32_t cnt{};
+        while (cnt < negotiation_verify_times && verify_clock()) {
+            ++cnt;
+        }
+        if (cnt == negotiation_verify_times) {
+            M5_LIB_LOGI("Negotiated clock:%u", clk);
+            _clock_transactions = _clock_errors = 0;
+            _clock_negotiated                   = true;
+            return true;
+        }
+        M5_LIB_LOGD("Unreliable clock:%u (%u/%u)", clk, cnt, negotiation_verify_times);
+    }
+    // Fallback to the configured clock
+    ad->setClock(_component_cfg.clock);
+    return verify_clock();
+}
+
+uint32_t Component::currentClock() const
+{
+    auto ad = asAdapter<AdapterI2C>(Adapter::Type::I2C);
+    return ad ? ad->clock() : 0U;
+}
+
+bool Component::verify_clock()
+{
+    auto ad = asAdapter<AdapterI2C>(Adapter::Type::I2C);
+    return ad && ad->wakeup() == m5::hal::error::error_t::OK;
+}
+
+void Component::monitor_clock(const m5::hal::error::error_t err)
+{
+    if (!_clock_negotiated) {
+        return;
+    }
+    ++_clock_transactions;
+    if (err != m5::hal::error::error_t::OK) {
+        ++_clock_errors;
+    }
+
+    if (_clock_errors >= clock_monitor_error_threshold) {
+        auto ad = asAdapter<AdapterI2C>(Adapter::Type::I2C);
+        if (ad) {
+            const uint32_t current = ad->clock();
+            uint32_t next          = _component_cfg.clock;
+            for (auto&& clk : negotiation_clocks) {
+                if (clk < current && clk > next) {
+                    next = clk;
+                    break;
+                }
+            }
+            M5_LIB_LOGW("Too many errors %u/%u at %u, step down to %u", _clock_errors, _clock_transactions, current,
+                        next);
+            ad->setClock(next);
+            _clock_negotiated = (next != _component_cfg.clock);  // Stop monitoring at the configured clock
+        }
+        _clock_transactions = _clock_errors = 0;
+        return;
+    }
+    if (_clock_transactions >= clock_monitor_window) {
+        _clock_transactions = _clock_errors = 0;
+    }
+}
+
+bool Component::rx_pending() const
+{
+#if defined(ESP_PLATFORM)
+    auto ad = asAdapter<AdapterUART>(Adapter::Type::UART);
+    if (ad && ad->eventRX()) {
+        return ad->rxReady();
+    }
+#endif
+    return true;
+}
+
 m5::hal::error::error_t Component::readWithTransaction(uint8_t* data, const size_t len)
 {
+    bus_lock_guard lock(adapter()->busLock());
     selectChannel(channel());
     auto r = adapter()->readWithTransaction(data, len);
+    monitor_clock(r);
+    return r;
+}
+
+m5::hal::error::error_t Component::readWithTransaction(const buffer_span_t* spans, const size_t count)
+{
+    bus_lock_guard lock(adapter()->busLock());
+    selectChannel(channel());
+    auto r = adapter()->readWithTransaction(spans, count);
+    monitor_clock(r);
     return r;
 }
 
 m5::hal::error::error_t Component::writeWithTransaction(const uint8_t* data, const size_t len, const uint32_t exparam)
 {
+    bus_lock_guard lock(adapter()->busLock());
     selectChannel(channel());
-    return adapter()->writeWithTransaction(data, len, exparam);
+    auto r = adapter()->writeWithTransaction(data, len, exparam);
+    monitor_clock(r);
+    return r;
+}
+
+m5::hal::error::error_t Component::transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len)
+{
+    bus_lock_guard lock(adapter()->busLock());
+    selectChannel(channel());
+    auto r = adapter()->transferWithTransaction(tx, rx, len);
+    monitor_clock(r);
+    return r;
 }
 
 template <typename Reg,
@@ -286,8 +420,11 @@ template <typename Reg,
 m5::hal::error::error_t Component::writeWithTransaction(const Reg reg, const uint8_t* data, const size_t len,
                                                         const bool stop)
 {
+    bus_lock_guard lock(adapter()->busLock());
     selectChannel(channel());
-    return adapter()->writeWithTransaction(reg, data, len, stop);
+    auto r = adapter()->writeWithTransaction(reg, data, len, stop);
+    monitor_clock(r);
+    return r;
 }
 
 template <typename Reg,
@@ -296,6 +433,8 @@ template <typename Reg,
 bool Component::readRegister(const Reg reg, uint8_t* rbuf, const size_t len, const uint32_t delayMillis,
                              const bool stop)
 {
+    // Keep the bus from the write to the read (the other task must not slip in after the write without stop)
+    bus_lock_guard lock(adapter()->busLock());
     if (!writeRegister(reg, nullptr, 0U, stop)) {
         M5_LIB_LOGE("Failed to write");
         return false;
@@ -305,6 +444,23 @@ bool Component::readRegister(const Reg reg, uint8_t* rbuf, const size_t len, con
     return (readWithTransaction(rbuf, len) == m5::hal::error::error_t::OK);
 }
 
+template <typename Reg,
+          typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
+                                  std::nullptr_t>::type>
+bool Component::readRegister(const Reg reg, const buffer_span_t* spans, const size_t count, const uint32_t delayMillis,
+                             const bool stop)
+{
+    // Keep the bus from the write to the read (the other task must not slip in after the write without stop)
+    bus_lock_guard lock(adapter()->busLock());
+    if (!writeRegister(reg, nullptr, 0U, stop)) {
+        M5_LIB_LOGE("Failed to write");
+        return false;
+    }
+
+    m5::utility::delay(delayMillis);
+    return (readWithTransaction(spans, count) == m5::hal::error::error_t::OK);
+}
+
 template <typename Reg,
           typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
                                   std::nullptr_t>::type>
@@ -423,6 +579,11 @@ bool Component::pulseInRX(uint32_t& duration, const int state, const uint32_t ti
     return adapter()->pulseInRX(duration, state, timeout_us) == m5::hal::error::error_t::OK;
 }
 
+bool Component::writeSequenceRX(const gpio::pin_step_t* steps, const size_t count)
+{
+    return adapter()->writeSequenceRX(steps, count) == m5::hal::error::error_t::OK;
+}
+
 bool Component::pinModeTX(const gpio::Mode m)
 {
     return adapter()->pinModeTX(m) == m5::hal::error::error_t::OK;
@@ -458,6 +619,11 @@ bool Component::pulseInTX(uint32_t& duration, const int state, const uint32_t ti
     return adapter()->pulseInTX(duration, state, timeout_us) == m5::hal::error::error_t::OK;
 }
 
+bool Component::writeSequenceTX(const gpio::pin_step_t* steps, const size_t count)
+{
+    return adapter()->writeSequenceTX(steps, count) == m5::hal::error::error_t::OK;
+}
+
 bool Component::changeAddress(const uint8_t addr)
 {
     if (canAccessI2C() && m5::utility::isValidI2CAddress(addr)) {
@@ -497,6 +663,10 @@ std::string Component::debugInfo() const
 // Explicit template instantiation
 template bool Component::readRegister<uint8_t>(const uint8_t, uint8_t*, const size_t, const uint32_t, const bool);
 template bool Component::readRegister<uint16_t>(const uint16_t, uint8_t*, const size_t, const uint32_t, const bool);
+template bool Component::readRegister<uint8_t>(const uint8_t, const buffer_span_t*, const size_t, const uint32_t,
+                                               const bool);
+template bool Component::readRegister<uint16_t>(const uint16_t, const buffer_span_t*, const size_t, const uint32_t,
+                                                const bool);
 template bool Component::readRegister8<uint8_t>(const uint8_t, uint8_t&, const uint32_t, const bool);
 template bool Component::readRegister8<uint16_t>(const uint16_t, uint8_t&, const uint32_t, const bool);
 template bool Component::read_register16E<uint8_t>(const uint8_t, uint16_t&, const uint32_t, const bool, const bool);
@@ -61,6 +61,12 @@ public:
         bool self_update{false};
         //! Maximum number of units that can be connected (default as 0)
         uint8_t max_children{0};
+        //! Negotiate the highest reliable I2C clock at begin? (default as false)
+        bool negotiate_clock{false};
+        //! Upper limit of the I2C clock for negotiation (default as 1000000)
+        uint32_t max_clock{1000000};
+        //! Skip the update by UnitUnified while event-driven UART RX has nothing received? (default as false)
+        bool update_on_rx{false};
     };
 
     ///@warning Define the same name and type in the derived class.
@@ -378,12 +384,14 @@ public:
 #if defined(ESP_PLATFORM) || defined(DOXYGEN_PROCESS)
     /*!
       @brief Assign SPI device handle (ESP-IDF native driver, borrowed)
-      @param handle ESP-IDF SPI device handle (create with spics_io_num = -1; init bus with SPI_DMA_DISABLED)
-      @param cs CS GPIO controlled manually by this library. If `GPIO_NUM_NC` (default), uses `address()` as the CS pin
-      (same convention as Arduino SPI)
+      @param handle ESP-IDF SPI device handle (create with spics_io_num = -1 unless hardware_cs).
+      If the bus is initialized with a DMA channel, AdapterSPI::setDMA can enable single large DMA transactions
+      @param cs CS GPIO. If `GPIO_NUM_NC` (default), uses `address()` as the CS pin (same convention as Arduino SPI)
+      @param hardware_cs CS is driven by the peripheral if true. The device must be created with spics_io_num = cs
+      (and cs_ena_pretrans/posttrans if the unit needs them). Otherwise CS is controlled manually by this library
       @return True if successful
      */
-    virtual bool assign(spi_device_handle_t handle, const gpio_num_t cs = GPIO_NUM_NC);
+    virtual bool assign(spi_device_handle_t handle, const gpio_num_t cs = GPIO_NUM_NC, const bool hardware_cs = false);
 #endif
     ///@}
 
@@ -530,6 +538,33 @@ public:
     }
     ///@endcond
 
+    /*!
+      @brief Execute the recorded operations as one transaction
+      @details Selects the channel once and acquires the bus once for the whole sequence
+      @param tb Recorded operations
+      @return Error code (OK if successful)
+    */
+    m5::hal::error::error_t executeTransaction(const TransactionBuilder& tb);
+
+    ///@name I2C clock negotiation
+    ///@{
+    /*!
+      @brief Negotiate the highest reliable I2C clock
+      @details Tries the standard clocks (1 MHz, 400 kHz) not exceeding component_config_t::max_clock, from the
+      highest, and settles on the first one for which verify_clock() passes repeatedly.
+      If none passes, component_config_t::clock is used
+      @return True if successful
+      @note Called by UnitUnified::begin if component_config_t::negotiate_clock is true
+      @note Once negotiated, the clock automatically steps down if the runtime error rate climbs
+    */
+    bool negotiateClock();
+    /*!
+      @brief Gets the I2C clock currently in use
+      @return Clock (0 if not I2C)
+    */
+    uint32_t currentClock() const;
+    ///@}
+
     /*!
       @brief General call for I2C
       @param data Pointer to data to send
@@ -549,6 +584,7 @@ public:
     // I2C R/W
     ///@cond 0
     m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len);
+    m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count);
 
     template <typename Reg,
               typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
@@ -558,6 +594,11 @@ public:
     template <typename Reg,
               typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
                                       std::nullptr_t>::type = nullptr>
+    bool readRegister(const Reg reg, const buffer_span_t* spans, const size_t count, const uint32_t delayMillis,
+                      const bool stop = true);
+    template <typename Reg,
+              typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
+                                      std::nullptr_t>::type = nullptr>
     bool readRegister8(const Reg reg, uint8_t& result, const uint32_t delayMillis, const bool stop = true);
 
     template <typename Reg,
@@ -594,6 +635,8 @@ public:
 
     m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len, const uint32_t exparam = 1);
 
+    m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len);
+
     template <typename Reg,
               typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
                                       std::nullptr_t>::type = nullptr>
@@ -650,6 +693,7 @@ public:
     bool readAnalogRX(uint16_t& v);
     bool readAnalogMilliVoltsRX(uint32_t& mv);
     bool pulseInRX(uint32_t& duration, const int state, const uint32_t timeout_us = 1000000);
+    bool writeSequenceRX(const gpio::pin_step_t* steps, const size_t count);
 
     bool pinModeTX(const gpio::Mode m);
     bool writeDigitalTX(const bool high);
@@ -658,6 +702,7 @@ public:
     bool readAnalogTX(uint16_t& v);
     bool readAnalogMilliVoltsTX(uint32_t& mv);
     bool pulseInTX(uint32_t& duration, const int state, const uint32_t timeout_us = 1000000);
+    bool writeSequenceTX(const gpio::pin_step_t* steps, const size_t count);
     ///@endcond
 
 #if defined(DOXYGEN_PROCESS)
@@ -667,10 +712,16 @@ public:
     ///@{
     //! @brief Read any data with transaction
     m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len);
+    //! @brief Read any data into the multiple destinations with transaction (scatter read)
+    m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count);
     //! @brief Read any data with transaction from register
     template <typename Reg>
     bool readRegister(const Reg reg, uint8_t* rbuf, const size_t len, const uint32_t delayMillis,
                       const bool stop = true);
+    //! @brief Read any data into the multiple destinations with transaction from register (scatter read)
+    template <typename Reg>
+    bool readRegister(const Reg reg, const buffer_span_t* spans, const size_t count, const uint32_t delayMillis,
+                      const bool stop = true);
     //! @brief Read byte with transaction from register
     template <typename Reg>
     bool readRegister8(const Reg reg, uint8_t& result, const uint32_t delayMillis, const bool stop = true);
@@ -711,6 +762,31 @@ public:
     //! @brief Write dword in little-endian order with transaction to register
     template <typename Reg>
     bool writeRegister32LE(const Reg reg, const uint32_t value, const bool stop = true);
+
+    //! @brief Send and receive simultaneously with transaction (full-duplex, e.g. SPI command and response)
+    m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len);
+    ///@}
+
+    ///@name GPIO
+    ///@{
+    /*!
+      @brief Drive the level sequence on the RX pin with tight timing
+      @param steps Levels and the hold times
+      @param count Number of the steps
+      @return True if successful
+      @warning Interrupts are disabled while driving, the total hold time is up to 1 ms
+      @note Fails if the pin cannot drive the output (e.g. input only pin)
+    */
+    bool writeSequenceRX(const gpio::pin_step_t* steps, const size_t count);
+    /*!
+      @brief Drive the level sequence on the TX pin with tight timing
+      @param steps Levels and the hold times
+      @param count Number of the steps
+      @return True if successful
+      @warning Interrupts are disabled while driving, the total hold time is up to 1 ms
+      @note Fails if the pin cannot drive the output (e.g. input only pin)
+    */
+    bool writeSequenceTX(const gpio::pin_step_t* steps, const size_t count);
     ///@}
 #endif
 
@@ -744,6 +820,17 @@ protected:
         return _component_cfg.stored_size;
     }
 
+    /*!
+      Verify the communication at the current I2C clock (for negotiateClock)
+      By default, only checks that the device acknowledges its address.
+      Override to read an identification register such as WHO_AM_I
+    */
+    virtual bool verify_clock();
+    // Feed the result of the transaction to the error rate monitor of the negotiated clock
+    void monitor_clock(const m5::hal::error::error_t err);
+    // Has the event-driven UART RX received data? (true if not event-driven RX)
+    bool rx_pending() const;
+
     bool add_child(Component* c);
 
     // I2C
@@ -783,6 +870,10 @@ private:
     uint8_t _addr{};
     bool _begun{};
 
+    // for clock negotiation
+    uint16_t _clock_transactions{}, _clock_errors{};
+    bool _clock_negotiated{};
+
     // for chain
     Component* _parent{};
     Component* _next{};
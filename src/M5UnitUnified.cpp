@@ -203,7 +203,7 @@ bool UnitUnified::add(Component& u, const uart_port_t uart_num)
 #endif
 
 #if defined(ESP_PLATFORM)
-bool UnitUnified::add(Component& u, spi_device_handle_t handle, const gpio_num_t cs)
+bool UnitUnified::add(Component& u, spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs)
 {
     if (u.isRegistered()) {
         M5_LIB_LOGW("Already added");
@@ -217,7 +217,7 @@ bool UnitUnified::add(Component& u, spi_device_handle_t handle, const gpio_num_t
     M5_LIB_LOGD("Add [%s] children:%zu", u.deviceName(), u.childrenSize());
 
     u._manager = this;
-    if (u.assign(handle, cs)) {
+    if (u.assign(handle, cs, hardware_cs)) {
         u._order = ++_registerCount;
         _units.emplace_back(&u);
         return add_children(u);
@@ -265,6 +265,9 @@ bool UnitUnified::begin()
     return !std::any_of(_units.begin(), _units.end(), [](Component* c) {
         M5_LIB_LOGV("Try begin:%s", c->deviceName());
         bool ret = c->_begun = c->begin();
+        if (ret && c->_component_cfg.negotiate_clock && c->adapter()->type() == Adapter::Type::I2C) {
+            c->negotiateClock();
+        }
         if (!ret) {
             M5_LIB_LOGE("Failed to begin: %s", c->debugInfo().c_str());
         }
@@ -277,6 +280,10 @@ void UnitUnified::update(const bool force)
     // Order of registration
     for (auto&& u : _units) {
         if (!u->_component_cfg.self_update && u->_begun) {
+            // Nothing to process until the event-driven UART RX receives
+            if (!force && u->_component_cfg.update_on_rx && !u->rx_pending()) {
+                continue;
+            }
             u->update(force);
         }
     }
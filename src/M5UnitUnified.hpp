@@ -160,12 +160,15 @@ public:
     /*!
       @brief Adding unit to be managed (SPI, ESP-IDF native driver)
       @param u Unit Component
-      @param handle ESP-IDF SPI device handle (create with spics_io_num = -1; init bus with SPI_DMA_DISABLED)
+      @param handle ESP-IDF SPI device handle (create with spics_io_num = -1).
+      If the bus is initialized with a DMA channel, AdapterSPI::setDMA can enable single large DMA transactions
       @param cs CS GPIO controlled manually by this library. If `GPIO_NUM_NC` (default), uses `Component::address()` as
       the CS pin (same convention as Arduino SPI)
+      @param hardware_cs CS is driven by the peripheral if true (create the device with spics_io_num = cs)
       @return True if successful
      */
-    bool add(Component& u, spi_device_handle_t handle, const gpio_num_t cs = GPIO_NUM_NC);
+    bool add(Component& u, spi_device_handle_t handle, const gpio_num_t cs = GPIO_NUM_NC,
+             const bool hardware_cs = false);
 #endif
     ///@}
 
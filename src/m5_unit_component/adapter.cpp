@@ -22,6 +22,47 @@ namespace m5 {
 namespace unit {
 
 // Adapter
+m5::hal::error::error_t Adapter::Impl::execute_operations(const transaction::op_t* ops, const size_t count,
+                                                          const bool i2c_stop)
+{
+    if (!ops && count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    // The exparam of the other buses is not the STOP flag (e.g. wait time), so the default is passed
+    for (size_t i = 0; !i2c_stop && i < count; ++i) {
+        if (!ops[i].stop && ops[i].type != transaction::OpType::Read && ops[i].type != transaction::OpType::Delay) {
+            M5_LIB_LOGE("Repeated START is not supported");
+            return m5::hal::error::error_t::NOT_IMPLEMENTED;
+        }
+    }
+
+    auto ret = m5::hal::error::error_t::OK;
+    for (size_t i = 0; ret == m5::hal::error::error_t::OK && i < count; ++i) {
+        const auto& op         = ops[i];
+        const uint32_t exparam = i2c_stop ? op.stop : 1U;
+        switch (op.type) {
+            case transaction::OpType::Write:
+                ret = writeWithTransaction(op.tx, op.len, exparam);
+                break;
+            case transaction::OpType::WriteReg8:
+                ret = writeWithTransaction(static_cast<uint8_t>(op.reg), op.tx, op.len, exparam);
+                break;
+            case transaction::OpType::WriteReg16:
+                ret = writeWithTransaction(op.reg, op.tx, op.len, exparam);
+                break;
+            case transaction::OpType::Read:
+                ret = readWithTransaction(op.rx, op.len);
+                break;
+            case transaction::OpType::Delay:
+                m5::utility::delay(op.delay_ms);
+                break;
+            default:
+                ret = m5::hal::error::error_t::INVALID_ARGUMENT;
+                break;
+        }
+    }
+    return ret;
+}
 
 }  // namespace unit
 }  // namespace m5
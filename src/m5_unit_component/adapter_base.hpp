@@ -12,12 +12,28 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include <M5HAL.hpp>
 #include "types.hpp"
+#include "transaction.hpp"
+#include "bus_lock.hpp"
 
 namespace m5 {
 namespace unit {
+
+/*!
+  @struct buffer_span_t
+  @brief Destination of the scatter read
+  @details e.g. {header, sizeof(header)}, {payload, payload_len} to read the header and payload of a FIFO
+  into separate buffers in one transaction
+ */
+struct buffer_span_t {
+    uint8_t* data{};  //!< Destination
+    size_t len{};     //!< Length of the destination
+};
+
 /*!
   @class m5::unit::Adapter
   @brief Adapter base class  to treat M5HAL and TwoWire,GPIO,Serial,SPI... in the same way
@@ -42,12 +58,53 @@ public:
         {
         }
 
+        //! @brief Gets the lock of the physical bus (nullptr if not shared)
+        inline BusLock* busLock() const
+        {
+            return _bus_lock;
+        }
+        virtual void beginTransaction()
+        {
+        }
+        virtual void endTransaction()
+        {
+        }
+
         ///@name I2C R/W
         ///@{
         virtual m5::hal::error::error_t readWithTransaction(uint8_t*, const size_t)
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
         }
+        // Scatter read. By default, read into the temporary buffer and distribute it
+        virtual m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count)
+        {
+            if (!spans || !count) {
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+            }
+            if (count == 1) {
+                return readWithTransaction(spans[0].data, spans[0].len);
+            }
+            size_t total{};
+            for (size_t i = 0; i < count; ++i) {
+                if (!spans[i].data && spans[i].len) {
+                    return m5::hal::error::error_t::INVALID_ARGUMENT;
+                }
+                total += spans[i].len;
+            }
+            std::vector<uint8_t> tmp(total);
+            auto ret = readWithTransaction(tmp.data(), total);
+            if (ret == m5::hal::error::error_t::OK) {
+                const uint8_t* p = tmp.data();
+                for (size_t i = 0; i < count; ++i) {
+                    if (spans[i].len) {
+                        std::memcpy(spans[i].data, p, spans[i].len);
+                    }
+                    p += spans[i].len;
+                }
+            }
+            return ret;
+        }
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t*, const size_t, const uint32_t)
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
@@ -66,6 +123,25 @@ public:
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
         }
+        // Execute the recorded operations. By default, execute them one by one (repeated START is not supported)
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count)
+        {
+            return execute_operations(ops, count, false);
+        }
+        // Full-duplex transfer. By default, only one direction (tx or rx is nullptr) is supported
+        virtual m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len)
+        {
+            if (!len || (!tx && !rx)) {
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+            }
+            if (!tx) {
+                return readWithTransaction(rx, len);
+            }
+            if (!rx) {
+                return writeWithTransaction(tx, len, 1);
+            }
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
         ///@}
         ///@name GPIO
         ///@{
@@ -97,6 +173,10 @@ public:
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
         }
+        virtual m5::hal::error::error_t writeSequenceRX(const gpio::pin_step_t*, const size_t)
+        {
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
 
         virtual m5::hal::error::error_t pinModeTX(const gpio::Mode)
         {
@@ -126,7 +206,19 @@ public:
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
         }
+        virtual m5::hal::error::error_t writeSequenceTX(const gpio::pin_step_t*, const size_t)
+        {
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
         ///@}
+
+    protected:
+        // Execute the operations one by one, op_t::stop is passed to the writes only if i2c_stop
+        m5::hal::error::error_t execute_operations(const transaction::op_t* ops, const size_t count,
+                                                   const bool i2c_stop);
+
+    protected:
+        BusLock* _bus_lock{};  // Set by the impl that accesses the shared bus
     };
 
     //! @brief Default constructor (creates Unknown type adapter)
@@ -164,13 +256,43 @@ public:
 
     ///@name Transaction control
     ///@{
-    //! @brief Begin a bus transaction
+    //! @brief Begin a bus transaction (Acquire the bus lock until endTransaction)
     inline virtual void beginTransaction()
     {
+        if (_impl->busLock()) {
+            _impl->busLock()->lock();
+        }
+        _impl->beginTransaction();
     }
     //! @brief End a bus transaction
     inline virtual void endTransaction()
     {
+        _impl->endTransaction();
+        if (_impl->busLock()) {
+            _impl->busLock()->unlock();
+        }
+    }
+    ///@}
+
+    ///@name Bus lock
+    ///@{
+    //! @brief Gets the lock of the physical bus (nullptr if not shared)
+    inline BusLock* busLock() const
+    {
+        return _impl->busLock();
+    }
+    /*!
+      @brief Gets the contention statistics of the physical bus
+      @param[out] stats Statistics
+      @return True if successful
+     */
+    inline bool busLockStats(bus_lock_stats_t& stats) const
+    {
+        if (_impl->busLock()) {
+            stats = _impl->busLock()->stats();
+            return true;
+        }
+        return false;
     }
     ///@}
 
@@ -179,28 +301,56 @@ public:
     //! @brief Read data within a transaction
     inline m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len)
     {
+        bus_lock_guard lock(_impl->busLock());
         return _impl->readWithTransaction(data, len);
     }
+    //! @brief Read data into the multiple destinations within a transaction
+    inline m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count)
+    {
+        bus_lock_guard lock(_impl->busLock());
+        return _impl->readWithTransaction(spans, count);
+    }
     inline m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                         const uint32_t exparam = 1)
     {
+        bus_lock_guard lock(_impl->busLock());
         return _impl->writeWithTransaction(data, len, exparam);
     }
     inline m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t* data, const size_t len,
                                                         const uint32_t exparam = 1)
     {
+        bus_lock_guard lock(_impl->busLock());
         return _impl->writeWithTransaction(reg, data, len, exparam);
     }
     inline m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                         const uint32_t exparam = 1)
     {
+        bus_lock_guard lock(_impl->busLock());
         return _impl->writeWithTransaction(reg, data, len, exparam);
     }
+    //! @brief Execute the recorded operations as one transaction
+    inline m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count)
+    {
+        bus_lock_guard lock(_impl->busLock());
+        return _impl->executeTransaction(ops, count);
+    }
     //! @brief Send a general call on the I2C bus
     inline m5::hal::error::error_t generalCall(const uint8_t* data, const size_t len)
     {
+        bus_lock_guard lock(_impl->busLock());
         return _impl->generalCall(data, len);
     }
+    /*!
+      @brief Send and receive simultaneously within a transaction (full-duplex)
+      @param tx Data to send (nullptr: receive only)
+      @param rx Destination (nullptr: send only)
+      @param len Length of both tx and rx
+     */
+    inline m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len)
+    {
+        bus_lock_guard lock(_impl->busLock());
+        return _impl->transferWithTransaction(tx, rx, len);
+    }
     ///@}
 
     ///@name GPIO RX pin operations
@@ -233,6 +383,16 @@ public:
     {
         return _impl->pulseInRX(duration, state, timeout_us);
     }
+    /*!
+      @brief Drive the level sequence with tight timing
+      @param steps Levels and the hold times
+      @param count Number of the steps
+      @warning Interrupts are disabled while driving, the total hold time is up to 1 ms (GPIO adapter)
+     */
+    inline m5::hal::error::error_t writeSequenceRX(const gpio::pin_step_t* steps, const size_t count)
+    {
+        return _impl->writeSequenceRX(steps, count);
+    }
 
     ///@}
     ///@name GPIO TX pin operations
@@ -265,6 +425,16 @@ public:
     {
         return _impl->pulseInTX(duration, state, timeout_us);
     }
+    /*!
+      @brief Drive the level sequence with tight timing
+      @param steps Levels and the hold times
+      @param count Number of the steps
+      @warning Interrupts are disabled while driving, the total hold time is up to 1 ms (GPIO adapter)
+     */
+    inline m5::hal::error::error_t writeSequenceTX(const gpio::pin_step_t* steps, const size_t count)
+    {
+        return _impl->writeSequenceTX(steps, count);
+    }
 
     ///@}
 
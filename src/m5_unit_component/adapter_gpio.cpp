@@ -11,6 +11,7 @@
 #include "adapter_gpio.hpp"
 #include <driver/gpio.h>
 #include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
 
 #if defined(M5_UNIT_UNIFIED_USING_RMT_V2)
 #pragma message "Using RMT v2,Oneshot"
@@ -43,9 +44,7 @@ constexpr auto M5_ADC_ATTEN_DB       = ADC_ATTEN_DB_11;
 
 #endif
 
-#if !defined(USING_RMT_CHANNNE_T)
 #include <driver/ledc.h>
-#endif
 
 #if SOC_ADC_SUPPORTED
 #pragma message "ADC supported"
@@ -53,7 +52,27 @@ constexpr auto M5_ADC_ATTEN_DB       = ADC_ATTEN_DB_11;
 #pragma message "ADC Not supported"
 #endif
 
+// Continuous sampling by the ADC DMA (ESP-IDF 5.x)
+#include <soc/soc_caps.h>
+#if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT) && defined(SOC_ADC_DMA_SUPPORTED) && SOC_ADC_DMA_SUPPORTED
+#define M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS
+#include <esp_adc/adc_continuous.h>
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0) && defined(SOC_ADC_DIG_IIR_FILTER_SUPPORTED) && \
+    SOC_ADC_DIG_IIR_FILTER_SUPPORTED
+#define M5_UNIT_UNIFIED_USING_ADC_IIR_FILTER
+#include <esp_adc/adc_filter.h>
+#endif
+#endif
+
 #include <esp_timer.h>
+#include <esp_rom_sys.h>
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include <esp_cpu.h>
+#else
+#include <hal/cpu_hal.h>
+#endif
+#include <atomic>
+#include <mutex>
 
 namespace {
 constexpr gpio_config_t gpio_cfg_table[] = {
@@ -311,15 +330,280 @@ constexpr int8_t gpio_to_adc_table[] = {
 #error Invalid target
 #endif
 
-// 0-9: ADC1 10-:ADC2 (ESP-IDF 4.x)
-// 0-9, 10- : ADC (ESP-IDF 5.x)
-int8_t gpio_to_adc_channel(const int8_t pin)
+constexpr uint8_t max_adc_channels{10};
+
+constexpr uint32_t pulse_capture_tick_ns{1000};  // 1 tick = 1 us
+constexpr uint32_t max_rmt_duration{32767};      // 15 bits
+constexpr uint32_t min_pulse_capture_items{64};
+
+// Table value 0-9: ADC1 10-:ADC2
+// unit 0:ADC1 1:ADC2
+bool gpio_to_adc(const int8_t pin, uint8_t& unit, uint8_t& channel)
 {
-    if (pin < 0 || pin >= m5::stl::size(gpio_to_adc_table)) {
-        return -1;
+    if (pin < 0 || pin >= m5::stl::size(gpio_to_adc_table) || gpio_to_adc_table[pin] < 0) {
+        return false;
+    }
+    auto v  = gpio_to_adc_table[pin];
+    unit    = v / max_adc_channels;
+    channel = v % max_adc_channels;
+    return true;
+}
+
+#if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT)
+// ADC units and calibrations shared by all adapters, released when no adapter refers to the unit
+struct adc_resident_t {
+    adc_oneshot_unit_handle_t handle{};
+    uint32_t refs{};
+    uint16_t configured{};   // Bits of the channels configured
+    uint16_t cali_failed{};  // Bits of the channels that can not be calibrated
+    adc_cali_handle_t cali[max_adc_channels]{};
+};
+std::mutex adc_mutex{};
+adc_resident_t adc_residents[2]{};  // ADC1, ADC2
+bool adc1_continuous{};             // ADC1 is used by the continuous sampling (oneshot can not be used)
+
+void delete_adc_cali(adc_cali_handle_t cali)
+{
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_delete_scheme_curve_fitting(cali);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_delete_scheme_line_fitting(cali);
+#endif
+}
+
+// Call with adc_mutex locked
+bool acquire_adc_unit(const uint8_t unit)
+{
+    if (unit == 0 && adc1_continuous) {
+        M5_LIB_LOGE("ADC1 is used by the continuous sampling");
+        return false;
+    }
+    auto& r = adc_residents[unit];
+    if (!r.handle) {
+        adc_oneshot_unit_init_cfg_t init_config{};
+        init_config.unit_id = (unit == 0) ? ADC_UNIT_1 : ADC_UNIT_2;
+        // clk_src member was added in ESP-IDF v5.1.0; v5.0.x has no such field
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#if SOC_ADC_RTC_CTRL_SUPPORTED
+#pragma message "ADC oneshot clk_src: RTC (ADC_RTC_CLK_SRC_DEFAULT)"
+        init_config.clk_src = ADC_RTC_CLK_SRC_DEFAULT;
+#else
+#pragma message "ADC oneshot clk_src: DIGI (ADC_DIGI_CLK_SRC_DEFAULT)"
+        init_config.clk_src = ADC_DIGI_CLK_SRC_DEFAULT;
+#endif
+#endif
+        init_config.ulp_mode = ADC_ULP_MODE_DISABLE;
+        if (adc_oneshot_new_unit(&init_config, &r.handle) != ESP_OK) {
+            r.handle = nullptr;
+            return false;
+        }
+    }
+    ++r.refs;
+    return true;
+}
+
+// Call with adc_mutex locked
+void release_adc_unit(const uint8_t unit)
+{
+    auto& r = adc_residents[unit];
+    if (!r.refs || --r.refs) {
+        return;
+    }
+    for (auto&& c : r.cali) {
+        if (c) {
+            delete_adc_cali(c);
+        }
+    }
+    if (r.handle) {
+        adc_oneshot_del_unit(r.handle);
+    }
+    r = adc_resident_t{};
+}
+
+// Created at first use and kept while the unit is resident
+adc_cali_handle_t ensure_adc_cali(const uint8_t unit, const uint8_t channel)
+{
+    std::lock_guard<std::mutex> lock(adc_mutex);
+    auto& r = adc_residents[unit];
+    if (r.cali[channel] || (r.cali_failed & (1U << channel))) {
+        return r.cali[channel];
+    }
+
+    adc_cali_handle_t cali_handle{};
+    bool cali_ok{};
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_curve_fitting_config_t cali_config{};
+    cali_config.unit_id = (unit == 0) ? ADC_UNIT_1 : ADC_UNIT_2;
+    // chan member was added in ESP-IDF v5.1.0; v5.0.x has no such field
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    cali_config.chan = static_cast<adc_channel_t>(channel);
+#endif
+    cali_config.atten    = M5_ADC_ATTEN_DB;
+    cali_config.bitwidth = ADC_BITWIDTH_DEFAULT;
+    cali_ok              = (adc_cali_create_scheme_curve_fitting(&cali_config, &cali_handle) == ESP_OK);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_line_fitting_config_t cali_config = {
+        .unit_id      = (unit == 0) ? ADC_UNIT_1 : ADC_UNIT_2,
+        .atten        = M5_ADC_ATTEN_DB,
+        .bitwidth     = ADC_BITWIDTH_DEFAULT,
+#if CONFIG_IDF_TARGET_ESP32
+        .default_vref = 1100,  // Fallback Vref (mV); used only when eFuse has no calibration
+#endif
+    };
+    cali_ok = (adc_cali_create_scheme_line_fitting(&cali_config, &cali_handle) == ESP_OK);
+#endif
+    if (cali_ok) {
+        r.cali[channel] = cali_handle;
+    } else {
+        r.cali_failed |= (1U << channel);  // Not retry
+    }
+    return r.cali[channel];
+}
+#else
+// ADC characteristics shared by all adapters
+struct adc_resident_t {
+    esp_adc_cal_characteristics_t chars{};
+    bool characterized{};
+};
+std::mutex adc_mutex{};
+adc_resident_t adc_residents[2]{};  // ADC1, ADC2
+
+// Characterized at first use for each unit
+uint32_t adc_raw_to_millivolts(const uint8_t unit, const uint32_t raw)
+{
+    std::lock_guard<std::mutex> lock(adc_mutex);
+    auto& r = adc_residents[unit];
+    if (!r.characterized) {
+        esp_adc_cal_characterize(unit ? ADC_UNIT_2 : ADC_UNIT_1, M5_ADC_ATTEN_DB, ADC_WIDTH_BIT_12, 1100, &r.chars);
+        r.characterized = true;
+    }
+    return esp_adc_cal_raw_to_voltage(raw, &r.chars);
+}
+#endif
+
+#if defined(M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS)
+#if defined(CONFIG_IDF_TARGET_ESP32) || defined(CONFIG_IDF_TARGET_ESP32S2)
+constexpr adc_digi_output_format_t adc_output_format{ADC_DIGI_OUTPUT_FORMAT_TYPE1};
+inline uint8_t adc_result_channel(const adc_digi_output_data_t* d)
+{
+    return d->type1.channel;
+}
+inline uint16_t adc_result_value(const adc_digi_output_data_t* d)
+{
+    return d->type1.data;
+}
+#else
+constexpr adc_digi_output_format_t adc_output_format{ADC_DIGI_OUTPUT_FORMAT_TYPE2};
+inline uint8_t adc_result_channel(const adc_digi_output_data_t* d)
+{
+    return d->type2.channel;
+}
+inline uint16_t adc_result_value(const adc_digi_output_data_t* d)
+{
+    return d->type2.data;
+}
+#endif
+
+bool on_adc_pool_overflow(adc_continuous_handle_t, const adc_continuous_evt_data_t*, void* user_data)
+{
+    ++*static_cast<std::atomic<uint32_t>*>(user_data);
+    return false;
+}
+#endif
+
+// PWM by LEDC, the timers are shared by the channels of the same frequency and resolution
+constexpr ledc_mode_t pwm_speed_mode{LEDC_LOW_SPEED_MODE};
+#if defined(SOC_LEDC_TIMER_BIT_WIDTH)
+constexpr uint8_t max_pwm_resolution{SOC_LEDC_TIMER_BIT_WIDTH};
+#else
+constexpr uint8_t max_pwm_resolution{14};
+#endif
+
+struct pwm_timer_t {
+    uint32_t frequency_hz{};
+    uint8_t bits{};
+    uint8_t refs{};  // Channels using the timer
+};
+std::mutex pwm_mutex{};
+pwm_timer_t pwm_timers[LEDC_TIMER_MAX]{};
+int8_t pwm_channel_timers[LEDC_CHANNEL_MAX]{};  // Timer of the channel + 1 (0: Free)
+bool pwm_fade_installed{};
+
+// Allocated from the highest, the lower ones are often taken by the other libraries (e.g. Arduino ledcAttach)
+// Call with pwm_mutex locked
+int acquire_pwm_timer(const uint32_t frequency_hz, const uint8_t bits)
+{
+    for (int t = LEDC_TIMER_MAX - 1; t >= 0; --t) {
+        auto& pt = pwm_timers[t];
+        if (pt.refs && pt.frequency_hz == frequency_hz && pt.bits == bits) {
+            ++pt.refs;
+            return t;
+        }
+    }
+    for (int t = LEDC_TIMER_MAX - 1; t >= 0; --t) {
+        auto& pt = pwm_timers[t];
+        if (!pt.refs) {
+            ledc_timer_config_t cfg{};
+            cfg.speed_mode      = pwm_speed_mode;
+            cfg.duty_resolution = static_cast<ledc_timer_bit_t>(bits);
+            cfg.timer_num       = static_cast<ledc_timer_t>(t);
+            cfg.freq_hz         = frequency_hz;
+            cfg.clk_cfg         = LEDC_AUTO_CLK;
+            if (ledc_timer_config(&cfg) != ESP_OK) {
+                M5_LIB_LOGE("Failed to configure LEDC timer %d (%lu Hz %u bits)", t, (unsigned long)frequency_hz, bits);
+                return -1;
+            }
+            pt = pwm_timer_t{frequency_hz, bits, 1};
+            return t;
+        }
+    }
+    M5_LIB_LOGE("No LEDC timer available");
+    return -1;
+}
+
+// Call with pwm_mutex locked
+void release_pwm_timer(const int t)
+{
+    auto& pt = pwm_timers[t];
+    if (pt.refs && !--pt.refs) {
+        ledc_timer_pause(pwm_speed_mode, static_cast<ledc_timer_t>(t));
     }
-    auto v = gpio_to_adc_table[pin];
-    return (v < 10) ? v : v - 10;
+}
+
+// Call with pwm_mutex locked
+int acquire_pwm_channel(const int timer)
+{
+    for (int ch = LEDC_CHANNEL_MAX - 1; ch >= 0; --ch) {
+        if (!pwm_channel_timers[ch]) {
+            pwm_channel_timers[ch] = timer + 1;
+            return ch;
+        }
+    }
+    M5_LIB_LOGE("No LEDC channel available");
+    return -1;
+}
+
+// Call with pwm_mutex locked
+void release_pwm_channel(const int ch)
+{
+    const int timer = pwm_channel_timers[ch] - 1;
+    if (timer >= 0) {
+        release_pwm_timer(timer);
+    }
+    pwm_channel_timers[ch] = 0;
+}
+
+// Interrupts are disabled while driving the sequence
+constexpr uint64_t max_sequence_ns{1000000};
+portMUX_TYPE sequence_mux = portMUX_INITIALIZER_UNLOCKED;
+
+inline uint32_t cpu_cycle_count()
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    return esp_cpu_get_cycle_count();
+#else
+    return cpu_hal_get_cycle_count();
+#endif
 }
 
 #if 0
@@ -337,74 +621,398 @@ int gpio_to_adc12(const int8_t pin)
 namespace m5 {
 namespace unit {
 
+struct AdapterGPIOBase::GPIOImpl::ADCContinuous {
+    ~ADCContinuous()
+    {
+#if defined(M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS)
+        if (started) {
+            adc_continuous_stop(handle);
+        }
+#if defined(M5_UNIT_UNIFIED_USING_ADC_IIR_FILTER)
+        for (auto&& f : filters) {
+            if (f) {
+                adc_continuous_iir_filter_disable(f);
+                adc_del_continuous_iir_filter(f);
+            }
+        }
+#endif
+        if (handle) {
+            adc_continuous_deinit(handle);
+        }
+        if (claimed) {
+            std::lock_guard<std::mutex> lock(adc_mutex);
+            adc1_continuous = false;
+        }
+#endif
+    }
+
+#if defined(M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS)
+    adc_continuous_handle_t handle{};
+#if defined(M5_UNIT_UNIFIED_USING_ADC_IIR_FILTER)
+    adc_iir_filter_handle_t filters[SOC_ADC_DIGI_IIR_FILTER_NUM]{};
+#endif
+#endif
+    bool claimed{};  // adc1_continuous is set by this
+    bool started{};
+    std::vector<uint8_t> raw{};  // Conversions read from the driver
+    size_t raw_pos{}, raw_len{};
+    int8_t index_of_channel[max_adc_channels]{};  // Index in the scan pattern, -1: Not scanned
+    std::vector<uint32_t> sums{};
+    std::vector<uint16_t> counts{};
+    uint16_t average{1};
+    std::atomic<uint32_t> overruns{};
+};
+
 AdapterGPIOBase::GPIOImpl::~GPIOImpl()
 {
+    endAnalogContinuous();
     release_adc_resources();
+    release_pwm(0);
+    release_pwm(1);
 }
 
 void AdapterGPIOBase::GPIOImpl::release_adc_resources()
 {
 #if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT)
-    if (_cali_handle) {
-        auto cali = static_cast<adc_cali_handle_t>(_cali_handle);
-#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
-        adc_cali_delete_scheme_curve_fitting(cali);
-#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
-        adc_cali_delete_scheme_line_fitting(cali);
-#endif
-        _cali_handle         = nullptr;
-        _cached_cali_channel = -1;
-    }
-    if (_adc_handle) {
-        adc_oneshot_del_unit(static_cast<adc_oneshot_unit_handle_t>(_adc_handle));
-        _adc_handle      = nullptr;
-        _cached_adc_unit = -1;
+    std::lock_guard<std::mutex> lock(adc_mutex);
+    for (uint8_t unit = 0; unit < 2; ++unit) {
+        if (_adc_units & (1U << unit)) {
+            release_adc_unit(unit);
+        }
     }
+    _adc_units = 0;
 #endif
 }
 
 m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::ensure_adc_handle(const gpio_num_t pin)
 {
 #if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT)
-    const auto ch = gpio_to_adc_channel(pin);
-    if (ch < 0) {
+    uint8_t unit{}, channel{};
+    if (!gpio_to_adc(pin, unit, channel)) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
-    int8_t needed_unit = (ch < 10) ? 0 : 1;
 
-    if (_adc_handle && _cached_adc_unit == needed_unit) {
+    std::lock_guard<std::mutex> lock(adc_mutex);
+    // The unit is kept while this adapter exists, even if the other unit is used alternately
+    if (!(_adc_units & (1U << unit))) {
+        if (!acquire_adc_unit(unit)) {
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+        _adc_units |= (1U << unit);
+    }
+    auto& r = adc_residents[unit];
+    if (!(r.configured & (1U << channel))) {
+        adc_oneshot_chan_cfg_t chan_config = {
+            .atten    = M5_ADC_ATTEN_DB,      // 0~3.3V
+            .bitwidth = ADC_BITWIDTH_DEFAULT  // 12bit
+        };
+        if (adc_oneshot_config_channel(r.handle, static_cast<adc_channel_t>(channel), &chan_config) != ESP_OK) {
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+        r.configured |= (1U << channel);
+    }
+    return m5::hal::error::error_t::OK;
+#else
+    return m5::hal::error::error_t::OK;
+#endif
+}
+
+// Pulse capture
+m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::beginPulseCapture(const gpio::pulse_capture_config_t& cfg)
+{
+    if (_pulse_capturing) {
+        // The RMT RX is already running, only the level and the number are changeable
+        _pulse_cfg.level      = cfg.level;
+        _pulse_cfg.max_pulses = cfg.max_pulses;
         return m5::hal::error::error_t::OK;
     }
+    if (!cfg.max_pulses || !cfg.timeout_us) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    if (rxConfigured()) {
+        // begin does not reconfigure the running RMT RX, so the capture settings would not be applied
+        M5_LIB_LOGE("RMT RX is already configured");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+
+    // 1 tick = 1 us, each item holds a pulse and the gap
+    gpio::adapter_config_t acfg{};
+    acfg.mode                    = gpio::Mode::RmtRX;
+    acfg.rx.tick_ns              = pulse_capture_tick_ns;
+    acfg.rx.mem_blocks           = 1;
+    acfg.rx.idle_ticks_threshold = static_cast<uint16_t>(std::min<uint32_t>(cfg.timeout_us, max_rmt_duration));
+    acfg.rx.ring_buffer_size     = static_cast<uint16_t>(
+        std::max<uint32_t>(cfg.max_pulses + 1U, min_pulse_capture_items) * sizeof(gpio::m5_rmt_item_t));
+    acfg.rx.read_timeout_ms = 0;
+    if (!begin(acfg)) {
+        M5_LIB_LOGE("Failed to begin RMT RX for pulse capture");
+        endRX();
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    _pulse_cfg       = cfg;
+    _pulse_capturing = true;
+    return m5::hal::error::error_t::OK;
+}
+
+void AdapterGPIOBase::GPIOImpl::endPulseCapture()
+{
+    if (_pulse_capturing) {
+        endRX();
+        _pulse_capturing = false;
+    }
+}
+
+size_t AdapterGPIOBase::GPIOImpl::readPulses(uint32_t* widths_us, const size_t count)
+{
+    gpio::rmt_frame_t frame{};
+    if (!_pulse_capturing || !widths_us || !receiveFrame(frame, 0)) {
+        return 0;
+    }
+    const size_t max = std::min<size_t>(count, _pulse_cfg.max_pulses);
+    const uint32_t level{_pulse_cfg.level ? 1U : 0U};
+    size_t n{};
+    for (size_t i = 0; i < frame.count && n < max; ++i) {
+        const auto& item = frame.symbols[i];
+        if (item.level0 == level && item.duration0) {
+            widths_us[n++] = item.duration0;
+        }
+        if (n < max && item.level1 == level && item.duration1) {
+            widths_us[n++] = item.duration1;
+        }
+        if (!item.duration0 || !item.duration1) {
+            break;  // End of the capture
+        }
+    }
+    releaseFrame(frame);
+    return n;
+}
+
+// Continuous sampling
+m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::beginAnalogContinuous(const gpio::adc_continuous_config_t& cfg)
+{
+#if defined(M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS)
+    endAnalogContinuous();
+
+    const std::vector<gpio_num_t> pins = cfg.pins.empty() ? std::vector<gpio_num_t>{rx_pin()} : cfg.pins;
+    if (pins.size() > SOC_ADC_PATT_LEN_MAX) {
+        M5_LIB_LOGE("Too many pins %zu", pins.size());
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+
+    std::unique_ptr<ADCContinuous> ac{new ADCContinuous{}};  // Released on failure
+    std::fill(std::begin(ac->index_of_channel), std::end(ac->index_of_channel), -1);
+    std::vector<adc_digi_pattern_config_t> pattern(pins.size());
+    for (size_t i = 0; i < pins.size(); ++i) {
+        const int pin  = pins[i];
+        const int8_t v = (pin >= 0 && pin < m5::stl::size(gpio_to_adc_table)) ? gpio_to_adc_table[pin] : -1;
+        // ADC1 only (ADC2 can not be used by DMA on some targets)
+        if (v < 0 || v >= max_adc_channels || ac->index_of_channel[v] >= 0) {
+            M5_LIB_LOGE("Invalid or duplicate ADC1 pin %d", pin);
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+        ac->index_of_channel[v] = static_cast<int8_t>(i);
+        pattern[i].atten        = M5_ADC_ATTEN_DB;
+        pattern[i].channel      = v;
+        pattern[i].unit         = ADC_UNIT_1;
+        pattern[i].bit_width    = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
 
-    // ADC unit changed — release everything and recreate
+    // The ADC unit can not be used by oneshot and continuous at the same time
     release_adc_resources();
+    {
+        std::lock_guard<std::mutex> lock(adc_mutex);
+        if (adc_residents[0].refs || adc1_continuous) {
+            M5_LIB_LOGE("ADC1 is used by other adapters (oneshot or continuous)");
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+        adc1_continuous = ac->claimed = true;
+    }
 
-    adc_unit_t unit = (needed_unit == 0) ? ADC_UNIT_1 : ADC_UNIT_2;
-    adc_oneshot_unit_handle_t handle{};
-    adc_oneshot_unit_init_cfg_t init_config{};
-    init_config.unit_id = unit;
-    // clk_src member was added in ESP-IDF v5.1.0; v5.0.x has no such field
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
-#if SOC_ADC_RTC_CTRL_SUPPORTED
-#pragma message "ADC oneshot clk_src: RTC (ADC_RTC_CLK_SRC_DEFAULT)"
-    init_config.clk_src = ADC_RTC_CLK_SRC_DEFAULT;
+    const uint32_t frame_samples = std::max<uint32_t>(cfg.frame_samples, 1);
+    adc_continuous_handle_cfg_t hcfg{};
+    hcfg.max_store_buf_size = std::max<uint32_t>(cfg.buffer_samples, frame_samples) * SOC_ADC_DIGI_RESULT_BYTES;
+    hcfg.conv_frame_size    = frame_samples * SOC_ADC_DIGI_RESULT_BYTES;
+    if (adc_continuous_new_handle(&hcfg, &ac->handle) != ESP_OK) {
+        M5_LIB_LOGE("Failed to create continuous ADC");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+
+    adc_continuous_config_t ccfg{};
+    ccfg.pattern_num    = pattern.size();
+    ccfg.adc_pattern    = pattern.data();
+    ccfg.sample_freq_hz = std::min<uint32_t>(std::max<uint32_t>(cfg.sample_rate_hz, SOC_ADC_SAMPLE_FREQ_THRES_LOW),
+                                             SOC_ADC_SAMPLE_FREQ_THRES_HIGH);
+    ccfg.conv_mode      = ADC_CONV_SINGLE_UNIT_1;
+    ccfg.format         = adc_output_format;
+    adc_continuous_evt_cbs_t cbs{};
+    cbs.on_pool_ovf = on_adc_pool_overflow;
+    if (adc_continuous_config(ac->handle, &ccfg) != ESP_OK ||
+        adc_continuous_register_event_callbacks(ac->handle, &cbs, &ac->overruns) != ESP_OK) {
+        M5_LIB_LOGE("Failed to configure continuous ADC");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+
+    if (cfg.iir_filter) {
+#if defined(M5_UNIT_UNIFIED_USING_ADC_IIR_FILTER)
+        adc_digi_iir_filter_coeff_t coeff{};
+        switch (cfg.iir_filter) {
+            case 2:
+                coeff = ADC_DIGI_IIR_FILTER_COEFF_2;
+                break;
+            case 4:
+                coeff = ADC_DIGI_IIR_FILTER_COEFF_4;
+                break;
+            case 8:
+                coeff = ADC_DIGI_IIR_FILTER_COEFF_8;
+                break;
+            case 16:
+                coeff = ADC_DIGI_IIR_FILTER_COEFF_16;
+                break;
+            case 64:
+                coeff = ADC_DIGI_IIR_FILTER_COEFF_64;
+                break;
+            default:
+                M5_LIB_LOGE("Invalid IIR coefficient %u", cfg.iir_filter);
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+        // Filters are limited, applied from the beginning of the pattern
+        const size_t fnum = std::min<size_t>(pins.size(), SOC_ADC_DIGI_IIR_FILTER_NUM);
+        for (size_t i = 0; i < fnum; ++i) {
+            adc_continuous_iir_filter_config_t fcfg{};
+            fcfg.unit    = ADC_UNIT_1;
+            fcfg.channel = static_cast<adc_channel_t>(pattern[i].channel);
+            fcfg.coeff   = coeff;
+            if (adc_new_continuous_iir_filter(ac->handle, &fcfg, &ac->filters[i]) != ESP_OK ||
+                adc_continuous_iir_filter_enable(ac->filters[i]) != ESP_OK) {
+                M5_LIB_LOGE("Failed to enable IIR filter");
+                return m5::hal::error::error_t::UNKNOWN_ERROR;
+            }
+        }
 #else
-#pragma message "ADC oneshot clk_src: DIGI (ADC_DIGI_CLK_SRC_DEFAULT)"
-    init_config.clk_src = ADC_DIGI_CLK_SRC_DEFAULT;
-#endif
+        M5_LIB_LOGW("IIR filter is not supported");
 #endif
-    init_config.ulp_mode = ADC_ULP_MODE_DISABLE;
+    }
+
+    ac->raw.resize(hcfg.conv_frame_size);
+    ac->sums.assign(pins.size(), 0);
+    ac->counts.assign(pins.size(), 0);
+    ac->average = std::max<uint16_t>(cfg.average, 1);
 
-    if (adc_oneshot_new_unit(&init_config, &handle) != ESP_OK) {
+    if (adc_continuous_start(ac->handle) != ESP_OK) {
+        M5_LIB_LOGE("Failed to start continuous ADC");
         return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
-
-    _adc_handle      = handle;
-    _cached_adc_unit = needed_unit;
+    ac->started     = true;
+    _adc_continuous = ac.release();
     return m5::hal::error::error_t::OK;
 #else
-    return m5::hal::error::error_t::OK;
+    (void)cfg;
+    return m5::hal::error::error_t::NOT_IMPLEMENTED;
+#endif
+}
+
+void AdapterGPIOBase::GPIOImpl::endAnalogContinuous()
+{
+    delete _adc_continuous;
+    _adc_continuous = nullptr;
+}
+
+size_t AdapterGPIOBase::GPIOImpl::readAnalogContinuous(gpio::adc_sample_t* samples, const size_t count)
+{
+    size_t n{};
+#if defined(M5_UNIT_UNIFIED_USING_ADC_CONTINUOUS)
+    auto ac = _adc_continuous;
+    if (!ac || !samples) {
+        return 0;
+    }
+    while (n < count) {
+        if (ac->raw_pos >= ac->raw_len) {
+            uint32_t len{};
+            ac->raw_pos = ac->raw_len = 0;
+            if (adc_continuous_read(ac->handle, ac->raw.data(), ac->raw.size(), &len, 0) != ESP_OK || !len) {
+                break;  // Drained
+            }
+            ac->raw_len = len;
+        }
+        for (; ac->raw_pos + SOC_ADC_DIGI_RESULT_BYTES <= ac->raw_len && n < count;
+             ac->raw_pos += SOC_ADC_DIGI_RESULT_BYTES) {
+            auto d           = reinterpret_cast<const adc_digi_output_data_t*>(ac->raw.data() + ac->raw_pos);
+            const uint8_t ch = adc_result_channel(d);
+            if (ch >= max_adc_channels || ac->index_of_channel[ch] < 0) {
+                continue;
+            }
+            const uint8_t idx = ac->index_of_channel[ch];
+            ac->sums[idx] += adc_result_value(d);
+            if (++ac->counts[idx] >= ac->average) {
+                samples[n].index = idx;
+                samples[n].value = static_cast<uint16_t>(ac->sums[idx] / ac->counts[idx]);
+                ++n;
+                ac->sums[idx]   = 0;
+                ac->counts[idx] = 0;
+            }
+        }
+    }
+#else
+    (void)samples;
+    (void)count;
 #endif
+    return n;
+}
+
+uint32_t AdapterGPIOBase::GPIOImpl::analogContinuousOverruns() const
+{
+    return _adc_continuous ? _adc_continuous->overruns.load() : 0;
+}
+
+// Encoders
+int AdapterGPIOBase::GPIOImpl::createBytesEncoder(const gpio::bytes_encoder_config_t& cfg)
+{
+    gpio::composite_encoder_config_t ccfg{};
+    ccfg.payload = cfg;
+    return createCompositeEncoder(ccfg);
+}
+
+int AdapterGPIOBase::GPIOImpl::createCompositeEncoder(const gpio::composite_encoder_config_t& cfg)
+{
+    _encoders.push_back(cfg);
+    if (!create_encoder(_encoders.size() - 1)) {
+        M5_LIB_LOGE("Failed to create encoder");
+        _encoders.pop_back();
+        return -1;
+    }
+    return static_cast<int>(_encoders.size() - 1);
+}
+
+bool AdapterGPIOBase::GPIOImpl::encode_items(std::vector<gpio::m5_rmt_item_t>& out, const int encoder,
+                                             const uint8_t* data, const size_t len) const
+{
+    if (encoder < 0 || static_cast<size_t>(encoder) >= _encoders.size() || (!data && len)) {
+        return false;
+    }
+    const auto& enc = _encoders[encoder];
+    out.clear();
+    out.reserve(enc.header.size() + len * 8 + enc.trailer.size());
+    out.insert(out.end(), enc.header.begin(), enc.header.end());
+    for (size_t i = 0; i < len; ++i) {
+        for (uint_fast8_t b = 0; b < 8; ++b) {
+            const uint8_t mask = enc.payload.msb_first ? (0x80 >> b) : (0x01 << b);
+            out.push_back((data[i] & mask) ? enc.payload.bit1 : enc.payload.bit0);
+        }
+    }
+    out.insert(out.end(), enc.trailer.begin(), enc.trailer.end());
+    return true;
+}
+
+m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::writeEncoded(const int encoder, const uint8_t* data,
+                                                                const size_t len, const uint32_t waitMs)
+{
+    std::vector<gpio::m5_rmt_item_t> items{};
+    if (!encode_items(items, encoder, data, len)) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    // Expanded items are released on return, so must wait
+    return writeWithTransaction(reinterpret_cast<const uint8_t*>(items.data()),
+                                items.size() * sizeof(gpio::m5_rmt_item_t), waitMs ? waitMs : portMAX_DELAY);
 }
 
 namespace gpio {
@@ -459,65 +1067,138 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_digital(const gpio_num_t
 
 m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::write_analog(const gpio_num_t pin, const uint16_t value)
 {
-    if (pin != 25 && pin != 26) {
-        // DAC output can 25 or 26
+    const int slot = pwm_slot(pin);
+    if (slot < 0) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
+    const int8_t ch = _pwm_channel[slot];
+    if (ch >= 0) {
+        // Only the duty is changed on the hot path
+        return (ledc_set_duty(pwm_speed_mode, static_cast<ledc_channel_t>(ch), pwm_duty(slot, value)) == ESP_OK &&
+                ledc_update_duty(pwm_speed_mode, static_cast<ledc_channel_t>(ch)) == ESP_OK)
+                   ? m5::hal::error::error_t::OK
+                   : m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+
 #if defined(USING_RMT_CHANNNE_T)
-    dac_channel_t ch = (pin == 25) ? DAC_CHANNEL_1 : DAC_CHANNEL_2;
-    dac_output_enable(ch);
-    dac_output_voltage(ch, static_cast<uint8_t>(value & 0xFF));  // 0〜255
+    if (pin == 25 || pin == 26) {
+        // DAC output can 25 or 26 (unless PWM is begun on the pin)
+        dac_channel_t dch = (pin == 25) ? DAC_CHANNEL_1 : DAC_CHANNEL_2;
+        dac_output_enable(dch);
+        dac_output_voltage(dch, static_cast<uint8_t>(value & 0xFF));  // 0〜255
+        return m5::hal::error::error_t::OK;
+    }
+#endif
+    // PWM with the default settings is begun at the first write
+    auto ret = begin_pwm(pin, gpio::pwm_config_t{});
+    return (ret == m5::hal::error::error_t::OK) ? write_analog(pin, value) : ret;
+}
+
+// PWM
+m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::begin_pwm(const gpio_num_t pin, const gpio::pwm_config_t& cfg)
+{
+    const int slot = pwm_slot(pin);
+    if (slot < 0 || !GPIO_IS_VALID_OUTPUT_GPIO(pin) || !cfg.frequency_hz || !cfg.resolution_bits ||
+        cfg.resolution_bits > max_pwm_resolution) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    release_pwm(slot);
+
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    const int timer = acquire_pwm_timer(cfg.frequency_hz, cfg.resolution_bits);
+    if (timer < 0) {
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    const int ch = acquire_pwm_channel(timer);
+    if (ch < 0) {
+        release_pwm_timer(timer);
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+
+    ledc_channel_config_t ch_cfg{};
+    ch_cfg.gpio_num            = static_cast<int>(pin);
+    ch_cfg.speed_mode          = pwm_speed_mode;
+    ch_cfg.channel             = static_cast<ledc_channel_t>(ch);
+    ch_cfg.intr_type           = LEDC_INTR_DISABLE;
+    ch_cfg.timer_sel           = static_cast<ledc_timer_t>(timer);
+    ch_cfg.duty                = 0;
+    ch_cfg.hpoint              = 0;
+    ch_cfg.flags.output_invert = cfg.invert;
+    if (ledc_channel_config(&ch_cfg) != ESP_OK) {
+        release_pwm_channel(ch);
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    _pwm_channel[slot] = ch;
+    _pwm_bits[slot]    = cfg.resolution_bits;
     return m5::hal::error::error_t::OK;
-#else
-    static bool ledc_timer_initialized = false;
-    if (!ledc_timer_initialized) {
-        ledc_timer_config_t timer_cfg = {};
-        timer_cfg.speed_mode          = LEDC_LOW_SPEED_MODE;
-        timer_cfg.duty_resolution     = LEDC_TIMER_8_BIT;
-        timer_cfg.timer_num           = LEDC_TIMER_0;
-        timer_cfg.freq_hz             = 5000;
-        timer_cfg.clk_cfg             = LEDC_AUTO_CLK;
-        if (ledc_timer_config(&timer_cfg) != ESP_OK) {
-            return m5::hal::error::error_t::UNKNOWN_ERROR;
-        }
-        ledc_timer_initialized = true;
-    }
-    const ledc_channel_t channel       = (pin == 25) ? LEDC_CHANNEL_0 : LEDC_CHANNEL_1;
-    const int idx                      = (pin == 25) ? 0 : 1;
-    static bool channel_initialized[2] = {false, false};
-    if (!channel_initialized[idx]) {
-        ledc_channel_config_t ch_cfg = {};
-        ch_cfg.gpio_num              = static_cast<int>(pin);
-        ch_cfg.speed_mode            = LEDC_LOW_SPEED_MODE;
-        ch_cfg.channel               = channel;
-        ch_cfg.intr_type             = LEDC_INTR_DISABLE;
-        ch_cfg.timer_sel             = LEDC_TIMER_0;
-        ch_cfg.duty                  = value & 0xFFu;
-        ch_cfg.hpoint                = 0;
-        if (ledc_channel_config(&ch_cfg) != ESP_OK) {
-            return m5::hal::error::error_t::UNKNOWN_ERROR;
+}
+
+void AdapterGPIOBase::GPIOImpl::end_pwm(const gpio_num_t pin)
+{
+    const int slot = pwm_slot(pin);
+    if (slot >= 0) {
+        release_pwm(slot);
+    }
+}
+
+m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::fade_pwm(const gpio_num_t pin, const uint16_t value,
+                                                            const uint32_t time_ms, const bool wait)
+{
+    const int slot = pwm_slot(pin);
+    if (slot < 0) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    if (_pwm_channel[slot] < 0) {
+        auto ret = begin_pwm(pin, gpio::pwm_config_t{});
+        if (ret != m5::hal::error::error_t::OK) {
+            return ret;
         }
-        channel_initialized[idx] = true;
-    } else {
-        if (ledc_set_duty(LEDC_LOW_SPEED_MODE, channel, value & 0xFFu) != ESP_OK ||
-            ledc_update_duty(LEDC_LOW_SPEED_MODE, channel) != ESP_OK) {
-            return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pwm_mutex);
+        if (!pwm_fade_installed) {
+            // ESP_ERR_INVALID_STATE if already installed by the other library
+            const auto err = ledc_fade_func_install(0);
+            if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
+                M5_LIB_LOGE("Failed to install LEDC fade %d", err);
+                return m5::hal::error::error_t::UNKNOWN_ERROR;
+            }
+            pwm_fade_installed = true;
         }
     }
-    return m5::hal::error::error_t::OK;
-#endif
+    const auto ch = static_cast<ledc_channel_t>(_pwm_channel[slot]);
+    return (ledc_set_fade_with_time(pwm_speed_mode, ch, pwm_duty(slot, value), static_cast<int>(time_ms)) == ESP_OK &&
+            ledc_fade_start(pwm_speed_mode, ch, wait ? LEDC_FADE_WAIT_DONE : LEDC_FADE_NO_WAIT) == ESP_OK)
+               ? m5::hal::error::error_t::OK
+               : m5::hal::error::error_t::UNKNOWN_ERROR;
+}
+
+void AdapterGPIOBase::GPIOImpl::release_pwm(const int slot)
+{
+    const int8_t ch = _pwm_channel[slot];
+    if (ch < 0) {
+        return;
+    }
+    ledc_stop(pwm_speed_mode, static_cast<ledc_channel_t>(ch), 0);
+    std::lock_guard<std::mutex> lock(pwm_mutex);
+    release_pwm_channel(ch);
+    _pwm_channel[slot] = -1;
 }
 
 m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog(uint16_t& value, const gpio_num_t pin)
 {
     value = 0;
+    if (_adc_continuous) {
+        M5_LIB_LOGE("Continuous sampling is running");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
 
-    const auto ch = gpio_to_adc_channel(pin);
-    if (ch < 0) {
+    uint8_t unit{}, ch{};
+    if (!gpio_to_adc(pin, unit, ch)) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
 #if !defined(SOC_ADC_PERIPH_NUM) || SOC_ADC_PERIPH_NUM <= 1
-    if (ch >= 10) {
+    if (unit) {
         M5_LIB_LOGE("Not support ADC2");
         return m5::hal::error::error_t::NOT_IMPLEMENTED;
     }
@@ -529,20 +1210,8 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog(uint16_t& value,
     if (err != m5::hal::error::error_t::OK) {
         return err;
     }
-
-    auto adc_handle       = static_cast<adc_oneshot_unit_handle_t>(_adc_handle);
-    adc_channel_t channel = static_cast<adc_channel_t>((ch < 10) ? ch : (ch - 10));
-
-    adc_oneshot_chan_cfg_t chan_config = {
-        .atten    = M5_ADC_ATTEN_DB,      // 0~3.3V
-        .bitwidth = ADC_BITWIDTH_DEFAULT  // 12bit
-    };
-
-    if (adc_oneshot_config_channel(adc_handle, channel, &chan_config) != ESP_OK) {
-        return m5::hal::error::error_t::UNKNOWN_ERROR;
-    }
     int raw{};
-    if (adc_oneshot_read(adc_handle, channel, &raw) != ESP_OK) {
+    if (adc_oneshot_read(adc_residents[unit].handle, static_cast<adc_channel_t>(ch), &raw) != ESP_OK) {
         return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
     value = static_cast<uint16_t>(raw);
@@ -551,9 +1220,9 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog(uint16_t& value,
 #else
     // ESP-IDF 4.x
     // ADC2
-    if (ch >= 10) {
+    if (unit) {
 #if SOC_ADC_SUPPORTED && SOC_ADC_PERIPH_NUM > 1
-        adc2_channel_t channel = static_cast<adc2_channel_t>(ch - 10);
+        adc2_channel_t channel = static_cast<adc2_channel_t>(ch);
         int v                  = 0;
         if (adc2_get_raw(channel, ADC_WIDTH_BIT_12, &v) != ESP_OK) {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
@@ -574,13 +1243,17 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog(uint16_t& value,
 m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog_millivolts(uint32_t& millivolts, const gpio_num_t pin)
 {
     millivolts = 0;
+    if (_adc_continuous) {
+        M5_LIB_LOGE("Continuous sampling is running");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
 
-    const auto ch = gpio_to_adc_channel(pin);
-    if (ch < 0) {
+    uint8_t unit{}, ch{};
+    if (!gpio_to_adc(pin, unit, ch)) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
 #if !defined(SOC_ADC_PERIPH_NUM) || SOC_ADC_PERIPH_NUM <= 1
-    if (ch >= 10) {
+    if (unit) {
         M5_LIB_LOGE("Not support ADC2");
         return m5::hal::error::error_t::NOT_IMPLEMENTED;
     }
@@ -588,76 +1261,16 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog_millivolts(uint32
 
 #if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT)
     // ESP-IDF 5.x: Use adc_cali for calibrated millivolt reading
-    auto err = ensure_adc_handle(pin);
+    uint16_t raw{};
+    auto err = read_analog(raw, pin);
     if (err != m5::hal::error::error_t::OK) {
         return err;
     }
 
-    auto adc_handle       = static_cast<adc_oneshot_unit_handle_t>(_adc_handle);
-    adc_channel_t channel = static_cast<adc_channel_t>((ch < 10) ? ch : (ch - 10));
-
-    adc_oneshot_chan_cfg_t chan_config = {
-        .atten    = M5_ADC_ATTEN_DB,      // 0~3.3V
-        .bitwidth = ADC_BITWIDTH_DEFAULT  // 12bit
-    };
-
-    if (adc_oneshot_config_channel(adc_handle, channel, &chan_config) != ESP_OK) {
-        return m5::hal::error::error_t::UNKNOWN_ERROR;
-    }
-
-    // Ensure calibration handle for this channel
-    if (_cached_cali_channel != ch) {
-        // Release old cali handle if any
-        if (_cali_handle) {
-            auto old_cali = static_cast<adc_cali_handle_t>(_cali_handle);
-#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
-            adc_cali_delete_scheme_curve_fitting(old_cali);
-#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
-            adc_cali_delete_scheme_line_fitting(old_cali);
-#endif
-            _cali_handle = nullptr;
-        }
-
-        adc_unit_t unit = (_cached_adc_unit == 0) ? ADC_UNIT_1 : ADC_UNIT_2;
-        adc_cali_handle_t cali_handle{};
-        bool cali_ok{};
-
-#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
-        adc_cali_curve_fitting_config_t cali_config{};
-        cali_config.unit_id = unit;
-        // chan member was added in ESP-IDF v5.1.0; v5.0.x has no such field
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
-        cali_config.chan = channel;
-#endif
-        cali_config.atten    = M5_ADC_ATTEN_DB;
-        cali_config.bitwidth = ADC_BITWIDTH_DEFAULT;
-        cali_ok              = (adc_cali_create_scheme_curve_fitting(&cali_config, &cali_handle) == ESP_OK);
-#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
-        adc_cali_line_fitting_config_t cali_config = {
-            .unit_id      = unit,
-            .atten        = M5_ADC_ATTEN_DB,
-            .bitwidth     = ADC_BITWIDTH_DEFAULT,
-#if CONFIG_IDF_TARGET_ESP32
-            .default_vref = 1100,  // Fallback Vref (mV); used only when eFuse has no calibration
-#endif
-        };
-        cali_ok = (adc_cali_create_scheme_line_fitting(&cali_config, &cali_handle) == ESP_OK);
-#endif
-
-        if (cali_ok) {
-            _cali_handle         = cali_handle;
-            _cached_cali_channel = ch;
-        }
-    }
-
-    int raw{};
-    if (adc_oneshot_read(adc_handle, channel, &raw) != ESP_OK) {
-        return m5::hal::error::error_t::UNKNOWN_ERROR;
-    }
-
-    if (_cali_handle) {
+    auto cali = ensure_adc_cali(unit, ch);
+    if (cali) {
         int mv{};
-        if (adc_cali_raw_to_voltage(static_cast<adc_cali_handle_t>(_cali_handle), raw, &mv) == ESP_OK) {
+        if (adc_cali_raw_to_voltage(cali, raw, &mv) == ESP_OK) {
             millivolts = static_cast<uint32_t>(mv);
             return m5::hal::error::error_t::OK;
         }
@@ -675,10 +1288,7 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::read_analog_millivolts(uint32
         return err;
     }
 
-    adc_unit_t unit = (ch < 10) ? ADC_UNIT_1 : ADC_UNIT_2;
-    esp_adc_cal_characteristics_t chars{};
-    esp_adc_cal_characterize(unit, M5_ADC_ATTEN_DB, ADC_WIDTH_BIT_12, 1100, &chars);
-    millivolts = esp_adc_cal_raw_to_voltage(raw, &chars);
+    millivolts = adc_raw_to_millivolts(unit, raw);
     return m5::hal::error::error_t::OK;
 #endif
 }
@@ -721,6 +1331,49 @@ m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::pulse_in(uint32_t& duration,
     return m5::hal::error::error_t::OK;
 }
 
+// Placed in IRAM so that the timing is not disturbed by the flash cache
+IRAM_ATTR m5::hal::error::error_t AdapterGPIOBase::GPIOImpl::write_sequence(const gpio_num_t pin,
+                                                                            const gpio::pin_step_t* steps,
+                                                                            const size_t count)
+{
+    gpio::FastPin fp(pin);
+    if (!fp.valid() || !steps || !count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    // Input only pins would silently stay undriven
+    if (!GPIO_IS_VALID_OUTPUT_GPIO(pin)) {
+        M5_LIB_LOGE("Not an output pin %d", pin);
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    uint64_t total{};
+    for (size_t i = 0; i < count; ++i) {
+        total += steps[i].hold_ns;
+    }
+    if (total > max_sequence_ns) {
+        M5_LIB_LOGE("Sequence too long %llu ns", (unsigned long long)total);
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+
+    // Each deadline is counted from the previous one, so the time to switch the level does not accumulate
+    const uint32_t cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+    portENTER_CRITICAL(&sequence_mux);
+    uint32_t deadline = cpu_cycle_count();
+    for (size_t i = 0; i < count; ++i) {
+        const auto& step = steps[i];
+        if (step.release) {
+            fp.input();
+        } else {
+            fp.write(step.level);
+            fp.output();
+        }
+        deadline += step.hold_ns * cycles_per_us / 1000U;
+        while (static_cast<int32_t>(cpu_cycle_count() - deadline) < 0) {
+        }
+    }
+    portEXIT_CRITICAL(&sequence_mux);
+    return m5::hal::error::error_t::OK;
+}
+
 AdapterGPIOBase::AdapterGPIOBase(GPIOImpl* impl) : Adapter(Adapter::Type::GPIO, impl)
 {
 }
@@ -14,6 +14,8 @@
 #include "identify_functions.hpp"
 #include "types.hpp"
 #include "adapter_base.hpp"
+#include "rmt_capture.hpp"
+#include "fast_gpio.hpp"
 
 namespace m5 {
 namespace unit {
@@ -66,6 +68,116 @@ public:
             return false;
         }
 
+        ///@name Encoders
+        ///@{
+        /*!
+          @brief Register the bytes encoder
+          @return Encoder id, -1 if failed
+         */
+        int createBytesEncoder(const gpio::bytes_encoder_config_t& cfg);
+        /*!
+          @brief Register the composite encoder
+          @return Encoder id, -1 if failed
+         */
+        int createCompositeEncoder(const gpio::composite_encoder_config_t& cfg);
+        /*!
+          @brief Encode the payload and send
+          @note V1 encodes by the RMT translator (ESP-IDF 4.3 or later), V2 by the RMT encoder while sending
+          The items are expanded in the adapter only if not available
+         */
+        virtual m5::hal::error::error_t writeEncoded(const int encoder, const uint8_t* data, const size_t len,
+                                                     const uint32_t waitMs);
+        ///@}
+
+        ///@name Zero-copy receive
+        ///@{
+        //! @brief Borrow the received items (V2)
+        virtual const uint8_t* acquireReceived(size_t& len, const uint32_t)
+        {
+            len = 0;
+            return nullptr;
+        }
+        //! @brief Return the borrowed items (V2)
+        virtual void releaseReceived(const uint8_t*)
+        {
+        }
+        //! @brief Gets the next received frame
+        virtual bool receiveFrame(gpio::rmt_frame_t& frame, const uint32_t)
+        {
+            frame = gpio::rmt_frame_t{};
+            return false;
+        }
+        //! @brief Return the frame given by receiveFrame
+        virtual void releaseFrame(const gpio::rmt_frame_t&)
+        {
+        }
+        //! @brief Gets the number of receptions dropped because no buffer was free
+        virtual uint32_t receiveDropped() const
+        {
+            return 0;
+        }
+        //! @brief Gets the metrics of the receive worker (V2)
+        virtual bool receiveWorkerStats(gpio::rx_worker_stats_t&) const
+        {
+            return false;
+        }
+        //! @brief Reset the metrics of the receive worker (V2)
+        virtual void resetReceiveWorkerStats()
+        {
+        }
+        ///@}
+
+        ///@name Pulse capture
+        ///@{
+        m5::hal::error::error_t beginPulseCapture(const gpio::pulse_capture_config_t& cfg);
+        void endPulseCapture();
+        inline bool pulseCapturing() const
+        {
+            return _pulse_capturing;
+        }
+        size_t readPulses(uint32_t* widths_us, const size_t count);
+        ///@}
+
+        ///@name PWM
+        ///@{
+        inline m5::hal::error::error_t beginPWMRX(const gpio::pwm_config_t& cfg)
+        {
+            return begin_pwm(rx_pin(), cfg);
+        }
+        inline m5::hal::error::error_t beginPWMTX(const gpio::pwm_config_t& cfg)
+        {
+            return begin_pwm(tx_pin(), cfg);
+        }
+        inline void endPWMRX()
+        {
+            end_pwm(rx_pin());
+        }
+        inline void endPWMTX()
+        {
+            end_pwm(tx_pin());
+        }
+        inline m5::hal::error::error_t fadeAnalogRX(const uint16_t v, const uint32_t time_ms, const bool wait)
+        {
+            return fade_pwm(rx_pin(), v, time_ms, wait);
+        }
+        inline m5::hal::error::error_t fadeAnalogTX(const uint16_t v, const uint32_t time_ms, const bool wait)
+        {
+            return fade_pwm(tx_pin(), v, time_ms, wait);
+        }
+        ///@}
+
+        ///@name Continuous analog sampling
+        ///@{
+        m5::hal::error::error_t beginAnalogContinuous(const gpio::adc_continuous_config_t& cfg);
+        void endAnalogContinuous();
+        inline bool analogContinuous() const
+        {
+            return _adc_continuous != nullptr;
+        }
+        size_t readAnalogContinuous(gpio::adc_sample_t* samples, const size_t count);
+        uint32_t analogContinuousOverruns() const;
+        ///@}
+
         //! @brief Get the RMT TX channel (V1: rmt_channel_t, V2: -1)
         virtual int rmtTxChannel() const
         {
@@ -86,6 +198,15 @@ public:
         {
             return nullptr;
         }
+        //! @brief Is the RMT RX configured?
+        virtual bool rxConfigured() const
+        {
+            return false;
+        }
+        //! @brief Release the RMT RX
+        virtual void endRX()
+        {
+        }
 
         //
         inline virtual m5::hal::error::error_t pinModeRX(const gpio::Mode m) override
@@ -118,6 +239,11 @@ public:
         {
             return pulse_in(duration, rx_pin(), state, timeout_us);
         }
+        inline virtual m5::hal::error::error_t writeSequenceRX(const gpio::pin_step_t* steps,
+                                                                const size_t count) override
+        {
+            return write_sequence(rx_pin(), steps, count);
+        }
 
         //
         inline virtual m5::hal::error::error_t pinModeTX(const gpio::Mode m) override
@@ -149,6 +275,11 @@ public:
         {
             return pulse_in(duration, tx_pin(), state, timeout_us);
         }
+        inline virtual m5::hal::error::error_t writeSequenceTX(const gpio::pin_step_t* steps,
+                                                                const size_t count) override
+        {
+            return write_sequence(tx_pin(), steps, count);
+        }
 
     protected:
         m5::hal::error::error_t pin_mode(const gpio_num_t pin, const gpio::Mode m);
@@ -159,6 +290,23 @@ public:
         m5::hal::error::error_t read_analog_millivolts(uint32_t& millivolts, const gpio_num_t pin);
         m5::hal::error::error_t pulse_in(uint32_t& duration, const gpio_num_t pin, const int state,
                                          const uint32_t timeout_us);
+        m5::hal::error::error_t write_sequence(const gpio_num_t pin, const gpio::pin_step_t* steps,
+                                               const size_t count);
+        m5::hal::error::error_t begin_pwm(const gpio_num_t pin, const gpio::pwm_config_t& cfg);
+        void end_pwm(const gpio_num_t pin);
+        m5::hal::error::error_t fade_pwm(const gpio_num_t pin, const uint16_t value, const uint32_t time_ms,
+                                         const bool wait);
+
+    protected:
+        // Backend specific encoder for _encoders[idx]
+        virtual bool create_encoder(const size_t)
+        {
+            return true;
+        }
+        bool encode_items(std::vector<gpio::m5_rmt_item_t>& out, const int encoder, const uint8_t* data,
+                          const size_t len) const;
+
+        std::vector<gpio::composite_encoder_config_t> _encoders{};
 
     protected:
         m5::hal::error::error_t ensure_adc_handle(const gpio_num_t pin);
@@ -168,11 +316,27 @@ public:
         gpio::adapter_config_t _adapter_cfg{};
 
 #if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT)
-        void* _adc_handle{};              // adc_oneshot_unit_handle_t
-        void* _cali_handle{};             // adc_cali_handle_t
-        int8_t _cached_adc_unit{-1};      // 0=ADC1, 1=ADC2, -1=uninitialized
-        int8_t _cached_cali_channel{-1};  // cached calibration channel, -1=uninitialized
+        uint8_t _adc_units{};  // Bits of the shared ADC units referred (bit0: ADC1, bit1: ADC2)
 #endif
+        // PWM of the RX (0) and the TX (1) pin
+        inline int pwm_slot(const gpio_num_t pin) const
+        {
+            return (pin < 0) ? -1 : (pin == _rx_pin) ? 0 : (pin == _tx_pin) ? 1 : -1;
+        }
+        inline uint32_t pwm_duty(const int slot, const uint16_t v) const
+        {
+            const uint32_t full = 1U << _pwm_bits[slot];
+            return (v < full) ? v : full;
+        }
+        void release_pwm(const int slot);
+        int8_t _pwm_channel[2]{-1, -1};  // LEDC channel, -1: Not begun
+        uint8_t _pwm_bits[2]{};
+
+        gpio::pulse_capture_config_t _pulse_cfg{};
+        bool _pulse_capturing{};
+
+        struct ADCContinuous;
+        ADCContinuous* _adc_continuous{};  // Continuous sampling, nullptr if not running
     };
     //
     explicit AdapterGPIOBase(GPIOImpl* impl);
@@ -197,6 +361,263 @@ public:
     {
         return impl()->begin(cfg);
     }
+
+    ///@name Fast GPIO
+    ///@{
+    /*!
+      @brief Gets the RX pin accessed by the GPIO registers directly
+      @note The pin mode is not changed, configure it by FastPin::configure or pinModeRX
+     */
+    inline gpio::FastPin fastPinRX() const
+    {
+        return gpio::FastPin(rx_pin());
+    }
+    //! @brief Gets the TX pin accessed by the GPIO registers directly
+    inline gpio::FastPin fastPinTX() const
+    {
+        return gpio::FastPin(tx_pin());
+    }
+    ///@}
+
+    ///@name PWM
+    ///@{
+    /*!
+      @brief Begin PWM output on the RX pin
+      @param cfg Frequency, resolution and polarity
+      @return OK if started
+      @details A LEDC channel is allocated, and the timer is shared with the channels of the same frequency and
+      resolution. writeAnalogRX only changes the duty afterwards
+      @note writeAnalogRX begins with the default settings if not begun (DAC pins use the DAC instead)
+     */
+    inline m5::hal::error::error_t beginPWMRX(const gpio::pwm_config_t& cfg)
+    {
+        return impl()->beginPWMRX(cfg);
+    }
+    //! @brief Begin PWM output on the TX pin
+    inline m5::hal::error::error_t beginPWMTX(const gpio::pwm_config_t& cfg)
+    {
+        return impl()->beginPWMTX(cfg);
+    }
+    //! @brief End PWM output on the RX pin and free the LEDC channel
+    inline void endPWMRX()
+    {
+        impl()->endPWMRX();
+    }
+    //! @brief End PWM output on the TX pin and free the LEDC channel
+    inline void endPWMTX()
+    {
+        impl()->endPWMTX();
+    }
+    /*!
+      @brief Fade the duty of the RX pin by the hardware
+      @param v Target duty (0 - 2^resolution_bits)
+      @param time_ms Fade time
+      @param wait Wait for the completion if true
+      @warning Do not write the duty by writeAnalogRX until the fade is completed
+     */
+    inline m5::hal::error::error_t fadeAnalogRX(const uint16_t v, const uint32_t time_ms, const bool wait = false)
+    {
+        return impl()->fadeAnalogRX(v, time_ms, wait);
+    }
+    //! @brief Fade the duty of the TX pin by the hardware
+    inline m5::hal::error::error_t fadeAnalogTX(const uint16_t v, const uint32_t time_ms, const bool wait = false)
+    {
+        return impl()->fadeAnalogTX(v, time_ms, wait);
+    }
+    ///@}
+
+    ///@name Pulse capture
+    ///@{
+    /*!
+      @brief Begin capturing the pulses on the RX pin by RMT RX
+      @param cfg Level, timeout and maximum pulses
+      @return OK if started, UNKNOWN_ERROR if the RMT RX is already configured by begin
+      @details Pulse widths are measured by the hardware instead of pulseInRX busy-waiting
+      @warning The RMT RX of the adapter is used, can not be used with the other RMT RX usage
+     */
+    inline m5::hal::error::error_t beginPulseCapture(const gpio::pulse_capture_config_t& cfg)
+    {
+        return impl()->beginPulseCapture(cfg);
+    }
+    /*!
+      @brief End capturing the pulses
+      @details The RMT RX is released and can be configured again by begin
+     */
+    inline void endPulseCapture()
+    {
+        impl()->endPulseCapture();
+    }
+    //! @brief Is capturing the pulses?
+    inline bool pulseCapturing() const
+    {
+        return impl()->pulseCapturing();
+    }
+    /*!
+      @brief Gets the pulses of the next capture without blocking
+      @param[out] widths_us Widths of the pulses (us)
+      @param count Maximum number of the widths
+      @return Number of the widths stored, 0 if not captured yet
+      @note The whole capture is consumed, the pulses beyond count (or max_pulses) are discarded
+     */
+    inline size_t readPulses(uint32_t* widths_us, const size_t count)
+    {
+        return impl()->readPulses(widths_us, count);
+    }
+    ///@}
+
+    ///@name Continuous analog sampling
+    ///@{
+    /*!
+      @brief Begin continuous sampling by the ADC DMA
+      @param cfg Scan pattern, sample rate, averaging and buffering
+      @return OK if started, NOT_IMPLEMENTED if the ADC DMA is not available (ESP-IDF 4.x or target),
+      UNKNOWN_ERROR if ADC1 is still used by the oneshot reading or the continuous sampling of other adapters
+      @details Conversions are stored by DMA and drained by readAnalogContinuous, e.g. in the update of the unit
+      @warning The oneshot reading (readAnalogRX/TX) of all adapters fails on ADC1 while sampling
+     */
+    inline m5::hal::error::error_t beginAnalogContinuous(const gpio::adc_continuous_config_t& cfg)
+    {
+        return impl()->beginAnalogContinuous(cfg);
+    }
+    //! @brief End continuous sampling
+    inline void endAnalogContinuous()
+    {
+        impl()->endAnalogContinuous();
+    }
+    //! @brief Is continuous sampling running?
+    inline bool analogContinuous() const
+    {
+        return impl()->analogContinuous();
+    }
+    /*!
+      @brief Drain the samples without blocking
+      @param[out] samples Output buffer
+      @param count Maximum number of the samples
+      @return Number of the samples stored
+     */
+    inline size_t readAnalogContinuous(gpio::adc_sample_t* samples, const size_t count)
+    {
+        return impl()->readAnalogContinuous(samples, count);
+    }
+    //! @brief Gets the number of times the conversions were lost because they were not drained in time
+    inline uint32_t analogContinuousOverruns() const
+    {
+        return impl()->analogContinuousOverruns();
+    }
+    ///@}
+
+    ///@name Zero-copy receive
+    ///@{
+    /*!
+      @brief Borrow the received items
+      @param[out] len Length of the received items (bytes)
+      @param timeout_ms Time to wait for the reception
+      @return Pointer to gpio::m5_rmt_item_t array, nullptr if nothing received
+      @details The receive buffers are lent in turn. The next reception is armed into a free buffer
+      as soon as one completes, and the received buffer is not copied
+      @warning Call releaseReceived when done, the buffer is not reused until then
+      @note RMT v2 only (v1 returns nullptr, use readWithTransaction)
+     */
+    inline const uint8_t* acquireReceived(size_t& len, const uint32_t timeout_ms = 0)
+    {
+        return impl()->acquireReceived(len, timeout_ms);
+    }
+    //! @brief Return the items borrowed by acquireReceived
+    inline void releaseReceived(const uint8_t* items)
+    {
+        impl()->releaseReceived(items);
+    }
+    /*!
+      @brief Gets the next received frame
+      @param[out] frame Items, the number of the items, capture timestamp and overflow flag
+      @param timeout_ms 0: Non-blocking, gpio::wait_forever: Blocking, otherwise timeout
+      @return True if received
+      @warning Call releaseFrame when done, the buffer is not reused until then
+      @note The timestamp is taken in the receive ISR on v2, and when taken from the ring buffer on v1
+     */
+    inline bool receiveFrame(gpio::rmt_frame_t& frame, const uint32_t timeout_ms = 0)
+    {
+        return impl()->receiveFrame(frame, timeout_ms);
+    }
+    //! @brief Return the frame given by receiveFrame
+    inline void releaseFrame(const gpio::rmt_frame_t& frame)
+    {
+        impl()->releaseFrame(frame);
+    }
+    /*!
+      @brief Receive the next frame and store it compressed
+      @param capture Storage
+      @param timeout_ms Same as receiveFrame
+      @return True if the whole frame was stored
+      @note The receive buffer is released as soon as the frame is stored, so long captures are kept in the
+      compressed storage instead of the receive buffers
+     */
+    inline bool captureFrame(gpio::RMTCaptureWriter& capture, const uint32_t timeout_ms = 0)
+    {
+        gpio::rmt_frame_t frame{};
+        if (!receiveFrame(frame, timeout_ms)) {
+            return false;
+        }
+        const bool stored = capture.append(frame.symbols, frame.count) == frame.count;
+        releaseFrame(frame);
+        return stored;
+    }
+    //! @brief Gets the number of receptions dropped because no buffer was free
+    inline uint32_t receiveDropped() const
+    {
+        return impl()->receiveDropped();
+    }
+    /*!
+      @brief Gets the metrics of the receive worker
+      @param[out] stats Queue high-water mark, ISR to worker latency...
+      @return True if successful (RMT v2 RX only)
+      @note The worker topology is set by gpio::adapter_config_t::rx_config_t::worker
+     */
+    inline bool receiveWorkerStats(gpio::rx_worker_stats_t& stats) const
+    {
+        return impl()->receiveWorkerStats(stats);
+    }
+    //! @brief Reset the metrics of the receive worker
+    inline void resetReceiveWorkerStats()
+    {
+        impl()->resetReceiveWorkerStats();
+    }
+    ///@}
+
+    ///@name Encoders
+    ///@{
+    /*!
+      @brief Register the bytes encoder
+      @param cfg Items for bit 0 and bit 1
+      @return Encoder id for writeEncoded, -1 if failed
+     */
+    inline int createBytesEncoder(const gpio::bytes_encoder_config_t& cfg)
+    {
+        return impl()->createBytesEncoder(cfg);
+    }
+    /*!
+      @brief Register the composite encoder
+      @param cfg Header, payload encoding and trailer
+      @return Encoder id for writeEncoded, -1 if failed
+     */
+    inline int createCompositeEncoder(const gpio::composite_encoder_config_t& cfg)
+    {
+        return impl()->createCompositeEncoder(cfg);
+    }
+    /*!
+      @brief Encode the payload and send
+      @param encoder Encoder id
+      @param data Payload (e.g. GRB bytes of LEDs, IR address and command)
+      @param len Length of the payload
+      @param waitMs Time to wait for the completion (0: no wait, data must be valid until done)
+      @note No need to expand every bit into the RMT items
+     */
+    inline m5::hal::error::error_t writeEncoded(const int encoder, const uint8_t* data, const size_t len,
+                                                const uint32_t waitMs)
+    {
+        return impl()->writeEncoded(encoder, data, len, waitMs);
+    }
+    ///@}
 };
 
 }  // namespace unit
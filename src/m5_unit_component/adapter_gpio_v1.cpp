@@ -14,35 +14,91 @@
 
 // #include <esp_clk.h>
 #include <esp32/clk.h>
+#include <esp_timer.h>
+#include <soc/soc_caps.h>
+#include <atomic>
 using namespace m5::unit::gpio;
 
 namespace {
 
-uint32_t using_rmt_channel_bits{};
+#if defined(SOC_RMT_MEM_WORDS_PER_CHANNEL)
+constexpr uint32_t rmt_mem_items_per_block{SOC_RMT_MEM_WORDS_PER_CHANNEL};
+#else
+constexpr uint32_t rmt_mem_items_per_block{64};
+#endif
+
+// Channel n owns memory block n and borrows the following blocks if mem_block_num > 1
+// Low 16 bits: Channels in use, High 16 bits: Memory blocks in use
+std::atomic<uint32_t> rmt_allocation{};
+constexpr uint32_t block_shift{16};
+
+//! @brief Range of the channels for each direction [first, last)
+void rmt_channel_range(const bool rx, int& first, int& last)
+{
+#if defined(CONFIG_IDF_TARGET_ESP32S3)
+    first = rx ? 4 : 0;  // TX channel 0 - 3, RX channel 4 - 7
+    last  = rx ? RMT_CHANNEL_MAX : 4;
+#elif defined(CONFIG_IDF_TARGET_ESP32C6)
+    first = rx ? 2 : 0;  // TX channel 0 - 1, RX channel 2 - 3
+    last  = rx ? RMT_CHANNEL_MAX : 2;
+#else
+    (void)rx;
+    first = 0;  // Any channel
+    last  = RMT_CHANNEL_MAX;
+#endif
+}
+
+inline uint32_t block_mask(const int ch, const int blocks)
+{
+    return ((1U << blocks) - 1U) << (ch + block_shift);
+}
 
-rmt_channel_t retrieve_available_rmt_channel(const int8_t first = 0)
+// Best fit: The smallest free run of the blocks that holds the request, from the beginning of the run
+// Larger runs are kept for the channels that need more blocks
+int find_rmt_channel(const uint32_t state, const int first, const int last, const int blocks)
 {
-    for (int_fast8_t ch = first; ch < RMT_CHANNEL_MAX; ++ch) {
-        if (((1U << ch) & using_rmt_channel_bits) == 0) {
-            return (rmt_channel_t)ch;
+    int best{-1}, best_run{last - first + 1};
+    int ch = first;
+    while (ch < last) {
+        if (state & (1U << (ch + block_shift))) {
+            ++ch;
+            continue;
         }
+        int run{};
+        while (ch + run < last && !(state & (1U << (ch + run + block_shift)))) {
+            ++run;
+        }
+        if (run >= blocks && run < best_run) {
+            best     = ch;
+            best_run = run;
+        }
+        ch += run;
     }
-    return RMT_CHANNEL_MAX;
+    return best;
 }
 
-bool declare_use_rmt_channel(const int ch)
+//! @brief Reserve the channel and its memory blocks
+rmt_channel_t allocate_rmt_channel(const bool rx, const uint8_t blocks)
 {
-    if (ch >= 0 && ch < RMT_CHANNEL_MAX && ((1U << ch) & using_rmt_channel_bits) == 0) {
-        using_rmt_channel_bits |= (1U << ch);
-        return true;
+    int first{}, last{};
+    rmt_channel_range(rx, first, last);
+    uint32_t state = rmt_allocation.load();
+    for (;;) {
+        const int ch = find_rmt_channel(state, first, last, blocks);
+        if (ch < 0) {
+            return RMT_CHANNEL_MAX;
+        }
+        if (rmt_allocation.compare_exchange_weak(state, state | (1U << ch) | block_mask(ch, blocks))) {
+            return static_cast<rmt_channel_t>(ch);
+        }
+        // Retry with the updated state
     }
-    return false;
 }
 
-void clear_use_rmt_channel(const int ch)
+void free_rmt_channel(const int ch, const uint8_t blocks)
 {
     if (ch >= 0 && ch < RMT_CHANNEL_MAX) {
-        using_rmt_channel_bits &= ~(1U << ch);
+        rmt_allocation.fetch_and(~((1U << ch) | block_mask(ch, blocks)));
     }
 }
 
@@ -50,7 +106,7 @@ rmt_config_t to_rmt_config_tx(const adapter_config_t& cfg, const uint32_t apb_fr
 {
     rmt_config_t out{};
     out.rmt_mode          = RMT_MODE_TX;
-    out.mem_block_num     = std::min<uint8_t>(cfg.tx.mem_blocks, 8u);
+    out.mem_block_num     = std::min<uint8_t>(std::max<uint8_t>(cfg.tx.mem_blocks, 1), 8u);
     out.clk_div           = calculate_rmt_clk_div(apb_freq_hz, cfg.tx.tick_ns);
     out.tx_config.loop_en = cfg.tx.loop_enabled;
     //    out.tx_config.carrier_en     = cfg.tx.carrier_enabled;
@@ -63,7 +119,7 @@ rmt_config_t to_rmt_config_rx(const adapter_config_t& cfg, const uint32_t apb_fr
 {
     rmt_config_t out{};
     out.rmt_mode            = RMT_MODE_RX;
-    out.mem_block_num       = std::min<uint8_t>(cfg.rx.mem_blocks, 8u);
+    out.mem_block_num       = std::min<uint8_t>(std::max<uint8_t>(cfg.rx.mem_blocks, 1), 8u);
     out.clk_div             = calculate_rmt_clk_div(apb_freq_hz, cfg.rx.tick_ns);
     out.rx_config.filter_en = cfg.rx.filter_enabled;
     out.rx_config.filter_ticks_thresh =
@@ -99,6 +155,72 @@ void dump_rmt_config(const rmt_config_t& cfg, const char* title = "RMT CONFIG")
     }
 }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 3, 0)
+#define M5_UNIT_UNIFIED_USING_RMT_TRANSLATOR
+// State of writeEncoded, items are made by the translator while sending
+struct translator_context_t {
+    const rmt_item32_t* header{};
+    size_t header_num{};
+    const rmt_item32_t* trailer{};
+    size_t trailer_num{};
+    rmt_item32_t bit0{}, bit1{};
+    bool msb_first{};
+    uint8_t part{};  // 0:header 1:payload 2:trailer
+    size_t pos{};    // Index of the header/trailer item or the bit of the payload byte
+};
+
+// The driver calls this again until all the source is consumed, and does not after that
+// So the last byte is consumed with the trailer
+void translate_encoded(const void* src, rmt_item32_t* dest, size_t src_size, size_t wanted_num,
+                       size_t* translated_size, size_t* item_num)
+{
+    *translated_size = 0;
+    *item_num        = 0;
+    void* p{};
+    if (!src || !dest || rmt_translator_get_context(item_num, &p) != ESP_OK || !p) {
+        return;
+    }
+    auto ctx  = static_cast<translator_context_t*>(p);
+    auto data = static_cast<const uint8_t*>(src);
+    size_t used{}, n{};
+
+    while (n < wanted_num) {
+        if (ctx->part == 0) {
+            if (ctx->pos < ctx->header_num) {
+                dest[n++] = ctx->header[ctx->pos++];
+                continue;
+            }
+            ctx->part = 1;
+            ctx->pos  = 0;
+        }
+        if (ctx->part == 1) {
+            if (used < src_size) {
+                const uint8_t mask = ctx->msb_first ? (0x80 >> ctx->pos) : (0x01 << ctx->pos);
+                dest[n++]          = (data[used] & mask) ? ctx->bit1 : ctx->bit0;
+                if (++ctx->pos < 8) {
+                    continue;
+                }
+                ctx->pos = 0;
+                if (used + 1 < src_size) {
+                    ++used;
+                    continue;
+                }
+            }
+            ctx->part = 2;
+        }
+        if (ctx->pos >= ctx->trailer_num) {
+            break;
+        }
+        dest[n++] = ctx->trailer[ctx->pos++];
+    }
+    if (ctx->part == 2 && ctx->pos >= ctx->trailer_num) {
+        used = src_size;  // Completed
+    }
+    *translated_size = used;
+    *item_num        = n;
+}
+#endif
+
 #if 0
 void dump_items(const rmt_item32_t* items, const uint32_t item_num)
 {
@@ -129,19 +251,19 @@ public:
     {
         return _rx_config.channel;
     }
+    bool rxConfigured() const override
+    {
+        return _rx_config.channel != RMT_CHANNEL_MAX;
+    }
+    void endRX() override
+    {
+        release_rx(true);
+    }
 
     virtual ~GPIOImplV1()
     {
-        if (_tx_config.channel != RMT_CHANNEL_MAX) {
-            rmt_tx_stop(_tx_config.channel);
-            rmt_driver_uninstall(_tx_config.channel);
-            clear_use_rmt_channel(_tx_config.channel);
-        }
-        if (_rx_config.channel != RMT_CHANNEL_MAX) {
-            rmt_rx_stop(_rx_config.channel);
-            rmt_driver_uninstall(_rx_config.channel);
-            clear_use_rmt_channel(_rx_config.channel);
-        }
+        release_tx(true);
+        endRX();
     }
 
     virtual bool begin(const gpio::adapter_config_t& cfg) override
@@ -151,12 +273,13 @@ public:
         // RMT TX
         if (_tx_config.channel == RMT_CHANNEL_MAX &&
             (cfg.mode == gpio::Mode::RmtTX || cfg.mode == gpio::Mode::RmtRXTX)) {
-            rmt_channel_t ch = retrieve_available_rmt_channel();
+            auto tx_config   = to_rmt_config_tx(cfg, esp_clk_apb_freq());
+            rmt_channel_t ch = allocate_rmt_channel(false, tx_config.mem_block_num);
             if (ch >= RMT_CHANNEL_MAX) {
-                M5_LIB_LOGE("RMT(v1) No room on TX channel");
+                M5_LIB_LOGE("RMT(v1) No room on TX channel (%u blocks)", tx_config.mem_block_num);
                 return false;
             }
-            _tx_config          = to_rmt_config_tx(cfg, esp_clk_apb_freq());
+            _tx_config          = tx_config;
             _tx_config.channel  = ch;
             _tx_config.gpio_num = tx_pin();
 
@@ -165,12 +288,14 @@ public:
             auto err = rmt_config(&_tx_config);
             if (err != ESP_OK) {
                 M5_LIB_LOGE("Failed to config TX %d:%s", err, esp_err_to_name(err));
+                release_tx(false);
                 return false;
             }
 
             err = rmt_driver_install(_tx_config.channel, 0, 0);
             if (err != ESP_OK) {
                 M5_LIB_LOGE("Failed to install TX %d:%s", err, esp_err_to_name(err));
+                release_tx(false);
                 return false;
             }
 
@@ -178,26 +303,19 @@ public:
                 gpio_matrix_out(_tx_config.gpio_num, _tx_config.channel + RMT_SIG_OUT0_IDX, true, false);
             }
 
-            declare_use_rmt_channel(ch);
             M5_LIB_LOGI("Retrieve RMT(v1) TX %d/%u", tx_pin(), ch);
         }
         // RMT RX
         if (_rx_config.channel == RMT_CHANNEL_MAX &&
             (cfg.mode == gpio::Mode::RmtRX || cfg.mode == gpio::Mode::RmtRXTX)) {
-#if defined(CONFIG_IDF_TARGET_ESP32S3)
-            int8_t first = 4;  // RX channel 4 - 7
-#elif defined(CONFIG_IDF_TARGET_ESP32C6)
-            int8_t first = 2;  // RX channel 2 - 3
-#else
-            int8_t first = 0;
-#endif
-            rmt_channel_t ch = retrieve_available_rmt_channel(first);
+            auto rx_config   = to_rmt_config_rx(cfg, esp_clk_apb_freq());
+            rmt_channel_t ch = allocate_rmt_channel(true, rx_config.mem_block_num);
             if (ch >= RMT_CHANNEL_MAX) {
-                M5_LIB_LOGE("RMT(v1) No room on RX channel");
+                M5_LIB_LOGE("RMT(v1) No room on RX channel (%u blocks)", rx_config.mem_block_num);
                 return false;
             }
 
-            _rx_config          = to_rmt_config_rx(cfg, esp_clk_apb_freq());
+            _rx_config          = rx_config;
             _rx_config.channel  = ch;
             _rx_config.gpio_num = rx_pin();
 
@@ -206,12 +324,14 @@ public:
             auto err = rmt_config(&_rx_config);
             if (err != ESP_OK) {
                 M5_LIB_LOGE("Failed to config RX %d:%s", err, esp_err_to_name(err));
+                release_rx(false);
                 return false;
             }
 
             err = rmt_driver_install(_rx_config.channel, cfg.rx.ring_buffer_size, 0);
             if (err != ESP_OK) {
                 M5_LIB_LOGE("Failed to install RX %d:%s", err, esp_err_to_name(err));
+                release_rx(false);
                 return false;
             }
 
@@ -219,11 +339,11 @@ public:
                 gpio_matrix_in(_rx_config.gpio_num, _rx_config.channel + RMT_SIG_IN0_IDX, true);
             }
 
-            declare_use_rmt_channel(ch);
             M5_LIB_LOGI("Retrieve RMT(v1) RX %d/%u", rx_pin(), ch);
 
             if (rmt_rx_start(_rx_config.channel, true) != ESP_OK) {
                 M5_LIB_LOGE("Failed to start RX");
+                release_rx(true);
                 return false;
             }
 
@@ -287,30 +407,159 @@ public:
         }
 
         size_t max_len = len - 2;  // Top of 2bytes is receive length
-        size_t rx_size{};
-        rmt_item32_t* items = static_cast<rmt_item32_t*>(xRingbufferReceive(rb, &rx_size, pdMS_TO_TICKS(50)));
+        gpio::rmt_frame_t frame{};
+        const bool received  = receiveFrame(frame, _adapter_cfg.rx.read_timeout_ms);
+        const size_t rx_size = frame.count * sizeof(rmt_item32_t);
 
-        // dump_items(items, rx_size / sizeof(rmt_item32_t));
+        // dump_items(frame.symbols, frame.count);
         memcpy(data, "\0\0", 2);
-        if (items && rx_size) {
+        if (received && rx_size) {
             uint16_t rlen = std::min<uint16_t>(rx_size, max_len);
             memcpy(data, &rlen, sizeof(rlen));
-            memcpy(data + 2, items, rlen);
+            memcpy(data + 2, frame.symbols, rlen);
         }
-        if (items) {
-            vRingbufferReturnItem(rb, items);
+        if (received) {
+            releaseFrame(frame);
         }
         return rx_size ? m5::hal::error::error_t::OK : m5::hal::error::error_t::TIMEOUT_ERROR;
     }
 
+#if defined(M5_UNIT_UNIFIED_USING_RMT_TRANSLATOR)
+    m5::hal::error::error_t writeEncoded(const int encoder, const uint8_t* data, const size_t len,
+                                         const uint32_t waitMs) override
+    {
+        if (encoder < 0 || static_cast<size_t>(encoder) >= _encoders.size() || !data || !len) {
+            // Invalid, or only the header and the trailer
+            return AdapterGPIOBase::GPIOImpl::writeEncoded(encoder, data, len, waitMs);
+        }
+        if (_tx_config.channel == RMT_CHANNEL_MAX) {
+            M5_LIB_LOGE("Invalid channel");
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+
+        // The context is used by the translator until the previous sending is done
+        rmt_wait_tx_done(_tx_config.channel, portMAX_DELAY);
+        if (!_translator_installed) {
+            if (rmt_translator_init(_tx_config.channel, translate_encoded) != ESP_OK ||
+                rmt_translator_set_context(_tx_config.channel, &_translator) != ESP_OK) {
+                M5_LIB_LOGE("Failed to init translator");
+                return m5::hal::error::error_t::UNKNOWN_ERROR;
+            }
+            _translator_installed = true;
+        }
+        const auto& enc         = _encoders[encoder];
+        _translator             = translator_context_t{};
+        _translator.header      = enc.header.data();
+        _translator.header_num  = enc.header.size();
+        _translator.trailer     = enc.trailer.data();
+        _translator.trailer_num = enc.trailer.size();
+        _translator.bit0        = enc.payload.bit0;
+        _translator.bit1        = enc.payload.bit1;
+        _translator.msb_first   = enc.payload.msb_first;
+
+        auto err = rmt_write_sample(_tx_config.channel, data, len, false);
+        if (err != ESP_OK) {
+            M5_LIB_LOGE("Failed to write %d:%s", err, esp_err_to_name(err));
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+        if (waitMs) {
+            err = rmt_wait_tx_done(_tx_config.channel, waitMs);
+            if (err != ESP_OK) {
+                M5_LIB_LOGE("Failed to wait %d:%s", err, esp_err_to_name(err));
+            }
+        }
+        return err == ESP_OK ? m5::hal::error::error_t::OK : m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+#endif
+
+    bool receiveFrame(gpio::rmt_frame_t& frame, const uint32_t timeout_ms) override
+    {
+        frame = gpio::rmt_frame_t{};
+        RingbufHandle_t rb{};
+        if (_rx_config.channel == RMT_CHANNEL_MAX || rmt_get_ringbuf_handle(_rx_config.channel, &rb) != ESP_OK ||
+            rb == nullptr) {
+            return false;
+        }
+        const TickType_t ticks = (timeout_ms == gpio::wait_forever) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+        size_t rx_size{};
+        auto items = static_cast<rmt_item32_t*>(xRingbufferReceive(rb, &rx_size, ticks));
+        if (!items) {
+            return false;
+        }
+        frame.symbols      = items;
+        frame.count        = rx_size / sizeof(rmt_item32_t);
+        frame.timestamp_us = esp_timer_get_time();  // The driver does not record the capture time
+        // Longer frames than the RMT memory are truncated by the driver
+        frame.overflow = frame.count >= _rx_config.mem_block_num * rmt_mem_items_per_block;
+        return true;
+    }
+
+    void releaseFrame(const gpio::rmt_frame_t& frame) override
+    {
+        RingbufHandle_t rb{};
+        if (frame.symbols && rmt_get_ringbuf_handle(_rx_config.channel, &rb) == ESP_OK && rb) {
+            vRingbufferReturnItem(rb, const_cast<rmt_item32_t*>(frame.symbols));
+        }
+    }
+
 protected:
+    // Release the channel, the driver is uninstalled if installed
+    void release_tx(const bool installed)
+    {
+        if (_tx_config.channel != RMT_CHANNEL_MAX) {
+            if (installed) {
+                rmt_tx_stop(_tx_config.channel);
+                rmt_driver_uninstall(_tx_config.channel);
+            }
+            free_rmt_channel(_tx_config.channel, _tx_config.mem_block_num);
+            _tx_config.channel = RMT_CHANNEL_MAX;
+#if defined(M5_UNIT_UNIFIED_USING_RMT_TRANSLATOR)
+            _translator_installed = false;
+#endif
+        }
+    }
+    void release_rx(const bool installed)
+    {
+        if (_rx_config.channel != RMT_CHANNEL_MAX) {
+            if (installed) {
+                rmt_rx_stop(_rx_config.channel);
+                rmt_driver_uninstall(_rx_config.channel);
+            }
+            free_rmt_channel(_rx_config.channel, _rx_config.mem_block_num);
+            _rx_config.channel = RMT_CHANNEL_MAX;
+        }
+    }
+
     rmt_config_t _rx_config{}, _tx_config{};
+#if defined(M5_UNIT_UNIFIED_USING_RMT_TRANSLATOR)
+    translator_context_t _translator{};
+    bool _translator_installed{};
+#endif
 };
 
 AdapterGPIO::AdapterGPIO(const int8_t rx_pin, const int8_t tx_pin) : AdapterGPIOBase(new GPIOImplV1(rx_pin, tx_pin))
 {
 }
 
+gpio::rmt_usage_t AdapterGPIO::rmtUsage()
+{
+    const uint32_t state = rmt_allocation.load();
+    gpio::rmt_usage_t usage{};
+    usage.channels = RMT_CHANNEL_MAX;
+    usage.blocks   = RMT_CHANNEL_MAX;
+    uint8_t run{};
+    for (int i = 0; i < RMT_CHANNEL_MAX; ++i) {
+        usage.used_channels += (state >> i) & 1U;
+        if (state & (1U << (i + block_shift))) {
+            ++usage.used_blocks;
+            run = 0;
+            continue;
+        }
+        usage.largest_free_run = std::max<uint8_t>(usage.largest_free_run, ++run);
+    }
+    return usage;
+}
+
 //
 }  // namespace unit
 }  // namespace m5
@@ -21,6 +21,26 @@
 namespace m5 {
 namespace unit {
 
+namespace gpio {
+/*!
+  @struct m5::unit::gpio::rmt_usage_t
+  @brief Usage of the RMT channels and memory blocks (v1)
+ */
+struct rmt_usage_t {
+    uint8_t channels{};          ///< Number of the channels
+    uint8_t used_channels{};     ///< Channels in use
+    uint8_t blocks{};            ///< Number of the memory blocks
+    uint8_t used_blocks{};       ///< Blocks in use (including the blocks borrowed by the channels)
+    uint8_t largest_free_run{};  ///< Largest number of the contiguous free blocks
+    //! @brief Fragmentation (0.0: Not fragmented, 1.0: Free blocks are all scattered)
+    inline float fragmentation() const
+    {
+        const uint8_t free_blocks = blocks - used_blocks;
+        return free_blocks ? 1.0f - static_cast<float>(largest_free_run) / free_blocks : 0.0f;
+    }
+};
+}  // namespace gpio
+
 /*!
   @class m5::unit::AdapterGPIO
   @brief GPIO access adapter
@@ -28,6 +48,13 @@ namespace unit {
 class AdapterGPIO : public AdapterGPIOBase {
 public:
     AdapterGPIO(const int8_t rx_pin, const int8_t tx_pin);
+
+    /*!
+      @brief Gets the usage of the RMT channels and memory blocks
+      @details The channels are allocated best fit, a channel that needs several memory blocks
+      takes the smallest contiguous free blocks that hold them
+     */
+    static gpio::rmt_usage_t rmtUsage();
 };
 
 }  // namespace unit
@@ -15,10 +15,11 @@
 #include <freertos/task.h>
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
-#include <freertos/ringbuf.h>
 #include <esp_private/esp_clk.h>
 #include <soc/soc_caps.h>  // SOC_RMT_MEM_WORDS_PER_CHANNEL
 #include <soc/soc.h>       // PRO_CPU_NUM
+#include <esp_timer.h>
+#include <atomic>
 
 using namespace m5::unit::gpio;
 
@@ -137,6 +138,146 @@ void dump_rmt_config(const rmt_receive_config_t &cfg)
 #endif
 }
 
+#if !defined(RMT_ENCODER_FUNC_ATTR)
+#define RMT_ENCODER_FUNC_ATTR IRAM_ATTR
+#endif
+
+// Header (copy) + payload (bytes) + trailer (copy)
+struct composite_encoder_t {
+    rmt_encoder_t base;  // Must be first
+    rmt_encoder_handle_t copy{};
+    rmt_encoder_handle_t bytes{};
+    rmt_symbol_word_t *header{};
+    size_t header_num{};
+    rmt_symbol_word_t *trailer{};
+    size_t trailer_num{};
+    int state{};  // 0:header 1:payload 2:trailer
+};
+
+RMT_ENCODER_FUNC_ATTR size_t encode_composite(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
+                                              const void *primary_data, size_t data_size,
+                                              rmt_encode_state_t *ret_state)
+{
+    auto enc                         = reinterpret_cast<composite_encoder_t *>(encoder);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    int state                        = RMT_ENCODING_RESET;
+    size_t encoded{};
+
+    switch (enc->state) {
+        case 0:
+            if (enc->header_num) {
+                encoded += enc->copy->encode(enc->copy, channel, enc->header,
+                                             enc->header_num * sizeof(rmt_symbol_word_t), &session_state);
+                if (session_state & RMT_ENCODING_COMPLETE) {
+                    enc->state = 1;
+                }
+                if (session_state & RMT_ENCODING_MEM_FULL) {
+                    state |= RMT_ENCODING_MEM_FULL;
+                    break;
+                }
+            } else {
+                enc->state = 1;
+            }
+            // fall through
+        case 1:
+            encoded += enc->bytes->encode(enc->bytes, channel, primary_data, data_size, &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                enc->state = 2;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                break;
+            }
+            // fall through
+        case 2:
+            if (enc->trailer_num) {
+                encoded += enc->copy->encode(enc->copy, channel, enc->trailer,
+                                             enc->trailer_num * sizeof(rmt_symbol_word_t), &session_state);
+                if (session_state & RMT_ENCODING_COMPLETE) {
+                    enc->state = 0;
+                    state |= RMT_ENCODING_COMPLETE;
+                }
+                if (session_state & RMT_ENCODING_MEM_FULL) {
+                    state |= RMT_ENCODING_MEM_FULL;
+                }
+            } else {
+                enc->state = 0;
+                state |= RMT_ENCODING_COMPLETE;
+            }
+            break;
+        default:
+            break;
+    }
+    *ret_state = static_cast<rmt_encode_state_t>(state);
+    return encoded;
+}
+
+esp_err_t reset_composite(rmt_encoder_t *encoder)
+{
+    auto enc = reinterpret_cast<composite_encoder_t *>(encoder);
+    rmt_encoder_reset(enc->copy);
+    rmt_encoder_reset(enc->bytes);
+    enc->state = 0;
+    return ESP_OK;
+}
+
+esp_err_t delete_composite(rmt_encoder_t *encoder)
+{
+    auto enc = reinterpret_cast<composite_encoder_t *>(encoder);
+    if (enc->copy) {
+        rmt_del_encoder(enc->copy);
+    }
+    if (enc->bytes) {
+        rmt_del_encoder(enc->bytes);
+    }
+    delete[] enc->header;
+    delete[] enc->trailer;
+    delete enc;
+    return ESP_OK;
+}
+
+rmt_symbol_word_t *clone_symbols(const std::vector<rmt_symbol_word_t> &v)
+{
+    if (v.empty()) {
+        return nullptr;
+    }
+    auto p = new rmt_symbol_word_t[v.size()];
+    std::copy(v.begin(), v.end(), p);
+    return p;
+}
+
+rmt_encoder_handle_t create_rmt_encoder(const composite_encoder_config_t &cfg)
+{
+    rmt_bytes_encoder_config_t bcfg{};
+    bcfg.bit0            = cfg.payload.bit0;
+    bcfg.bit1            = cfg.payload.bit1;
+    bcfg.flags.msb_first = cfg.payload.msb_first;
+
+    rmt_encoder_handle_t bytes{};
+    if (rmt_new_bytes_encoder(&bcfg, &bytes) != ESP_OK) {
+        return nullptr;
+    }
+    if (cfg.header.empty() && cfg.trailer.empty()) {
+        return bytes;  // Plain bytes encoder
+    }
+
+    auto enc   = new composite_encoder_t{};
+    enc->bytes = bytes;
+    rmt_copy_encoder_config_t ccfg{};
+    if (rmt_new_copy_encoder(&ccfg, &enc->copy) != ESP_OK) {
+        delete_composite(&enc->base);
+        return nullptr;
+    }
+    enc->header       = clone_symbols(cfg.header);
+    enc->header_num   = cfg.header.size();
+    enc->trailer      = clone_symbols(cfg.trailer);
+    enc->trailer_num  = cfg.trailer.size();
+    enc->base.encode  = encode_composite;
+    enc->base.reset   = reset_composite;
+    enc->base.del     = delete_composite;
+    return &enc->base;
+}
+
 #if 0
 void dump_symbols(const rmt_symbol_word_t *symbols, const uint32_t symbol_num)
 {
@@ -168,21 +309,21 @@ public:
         return _rx_handle;
     }
 
+    bool rxConfigured() const override
+    {
+        return _rx_handle != nullptr;
+    }
+    void endRX() override;
+
     virtual ~GPIOImplV2()
     {
         if (_tx_handle) {
             rmt_disable(_tx_handle);
             rmt_del_channel(_tx_handle);
         }
-        if (_rx_handle) {
-            rmt_disable(_rx_handle);
-            rmt_del_channel(_rx_handle);
-        }
-        if (_ring_buf) {
-            vRingbufferDelete(_ring_buf);
-        }
-        if (_rx_buf) {
-            heap_caps_free(_rx_buf);
+        endRX();
+        for (auto &&e : _rmt_encoders) {
+            rmt_del_encoder(e);
         }
         vSemaphoreDelete(_sem);
     }
@@ -193,16 +334,43 @@ public:
     bool begin(const gpio::adapter_config_t &cfg);
     m5::hal::error::error_t writeWithTransaction(const uint8_t *data, const size_t len, const uint32_t waitMs) override;
     m5::hal::error::error_t readWithTransaction(uint8_t *data, const size_t len) override;
+    const uint8_t *acquireReceived(size_t &len, const uint32_t timeout_ms) override;
+    void releaseReceived(const uint8_t *items) override;
+    bool receiveFrame(gpio::rmt_frame_t &frame, const uint32_t timeout_ms) override;
+    void releaseFrame(const gpio::rmt_frame_t &frame) override;
+    uint32_t receiveDropped() const override
+    {
+        return _rx_dropped;
+    }
+    bool receiveWorkerStats(gpio::rx_worker_stats_t &stats) const override
+    {
+        if (!_worker_queue) {
+            return false;
+        }
+        stats = _worker_stats;
+        return true;
+    }
+    void resetReceiveWorkerStats() override
+    {
+        _worker_stats = gpio::rx_worker_stats_t{};
+    }
+    m5::hal::error::error_t writeEncoded(const int encoder, const uint8_t *data, const size_t len,
+                                         const uint32_t waitMs) override;
 
 protected:
+    bool create_encoder(const size_t idx) override;
+
     struct callback_struct_t {
         GPIOImplV2 *me{};
         uint16_t len{};
+        int64_t isr_us{};           // Time queued in the ISR
+        SemaphoreHandle_t fence{};  // Given when reached (not an event)
+        bool stop{};                // Stop the dedicated worker after the fence
     };
 
-    bool createReceiveTask();
-    static void receive_loop_task(void *);
-    void receive_loop(const uint16_t received_len);
+    bool createReceiveTask(const gpio::adapter_config_t::rx_config_t::worker_config_t &wcfg);
+    static void receive_loop_task(void *queue);
+    void receive_loop(const callback_struct_t &cs);
 
 protected:
     rmt_channel_handle_t _rx_handle{}, _tx_handle{};
@@ -211,17 +379,81 @@ protected:
     rmt_tx_channel_config_t _tx_config{};
     rmt_transmit_config_t _transmit_config{};
 
-    uint16_t _rx_buf_len{};
+    static constexpr uint8_t MAX_RX_BUFFERS{8};
+    inline uint8_t *rx_buffer(const uint8_t idx) const
+    {
+        return _rx_pool + idx * _rx_buf_len;
+    }
 
-    uint8_t *_rx_buf{};
-    RingbufHandle_t _ring_buf{};
+    uint16_t _rx_buf_len{};  // Size of each buffer
+    uint8_t _rx_buf_count{};
+    uint8_t _rx_current{};  // Buffer being received
+    uint16_t _rx_len[MAX_RX_BUFFERS]{};
+    int64_t _rx_stamp[MAX_RX_BUFFERS]{};  // Time of the capture
+    bool _rx_overflow[MAX_RX_BUFFERS]{};  // Buffer filled
+    uint8_t *_rx_pool{};
+    std::atomic<uint8_t> _rx_lent{};  // Bits of the buffers lent by receiveFrame/acquireReceived
+    QueueHandle_t _rx_free{};         // Indexes of the buffers to receive
+    QueueHandle_t _rx_full{};         // Indexes of the received buffers
+    volatile uint32_t _rx_dropped{};
 
     SemaphoreHandle_t _sem{};
 
+    std::vector<rmt_encoder_handle_t> _rmt_encoders{};  // Same index as _encoders
+
+    // Receive worker (shared or dedicated)
+    QueueHandle_t _worker_queue{};
+    bool _dedicated_worker{};
+    gpio::rx_worker_stats_t _worker_stats{};  // Updated by the ISR and the worker
+
     static QueueHandle_t _receive_queue;
     static TaskHandle_t _receive_task_handle;
+    // Settings of the shared worker
+    static gpio::adapter_config_t::rx_config_t::worker_config_t _receive_worker_cfg;
 };
 
+// Frames not returned by releaseFrame/releaseReceived must not be used after this
+void GPIOImplV2::endRX()
+{
+    if (_rx_handle) {
+        // No more events, and the worker does not arm the reception after this
+        xSemaphoreTake(_sem, portMAX_DELAY);
+        rmt_disable(_rx_handle);
+        rmt_del_channel(_rx_handle);
+        _rx_handle = nullptr;
+        xSemaphoreGive(_sem);
+    }
+    if (_worker_queue) {
+        // Wait until the events already queued for this are handled
+        // The dedicated worker deletes the queue and itself after the fence
+        SemaphoreHandle_t fence = xSemaphoreCreateBinary();
+        if (fence) {
+            callback_struct_t cs{};
+            cs.me    = this;
+            cs.fence = fence;
+            cs.stop  = _dedicated_worker;
+            xQueueSend(_worker_queue, &cs, portMAX_DELAY);
+            xSemaphoreTake(fence, portMAX_DELAY);
+            vSemaphoreDelete(fence);
+        }
+        _worker_queue     = nullptr;
+        _dedicated_worker = false;
+    }
+    if (_rx_free) {
+        vQueueDelete(_rx_free);
+        _rx_free = nullptr;
+    }
+    if (_rx_full) {
+        vQueueDelete(_rx_full);
+        _rx_full = nullptr;
+    }
+    if (_rx_pool) {
+        heap_caps_free(_rx_pool);
+        _rx_pool = nullptr;
+    }
+    _rx_lent = 0;
+}
+
 bool GPIOImplV2::begin(const gpio::adapter_config_t &cfg)
 {
     // RMT TX
@@ -250,22 +482,28 @@ bool GPIOImplV2::begin(const gpio::adapter_config_t &cfg)
 
     // RMT RX
     if (!_rx_handle && (cfg.mode == gpio::Mode::RmtRX || cfg.mode == gpio::Mode::RmtRXTX)) {
-        if (!createReceiveTask()) {
+        if (!createReceiveTask(cfg.rx.worker)) {
             return false;
         }
 
-        _rx_buf = (uint8_t *)heap_caps_malloc(cfg.rx.ring_buffer_size, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
-        if (!_rx_buf) {
-            M5_LIB_LOGE("Failed to allocate memory %u", cfg.rx.ring_buffer_size);
+        // Symbol aligned buffers, lent in turn
+        _rx_buf_len   = cfg.rx.ring_buffer_size & ~(sizeof(rmt_symbol_word_t) - 1);
+        _rx_buf_count = std::min<uint8_t>(std::max<uint8_t>(cfg.rx.buffer_count, 2), MAX_RX_BUFFERS);
+        _rx_pool = (uint8_t *)heap_caps_malloc(_rx_buf_len * _rx_buf_count, MALLOC_CAP_DMA | MALLOC_CAP_32BIT);
+        if (!_rx_buf_len || !_rx_pool) {
+            M5_LIB_LOGE("Failed to allocate memory %u x %u", _rx_buf_len, _rx_buf_count);
             return false;
         }
-
-        _ring_buf = xRingbufferCreate(cfg.rx.ring_buffer_size, RINGBUF_TYPE_NOSPLIT);
-        if (!_ring_buf) {
-            M5_LIB_LOGE("Failed to create ringbuffer");
+        _rx_free = xQueueCreate(_rx_buf_count, sizeof(uint8_t));
+        _rx_full = xQueueCreate(_rx_buf_count, sizeof(uint8_t));
+        if (!_rx_free || !_rx_full) {
+            M5_LIB_LOGE("Failed to create queues");
             return false;
         }
-        _rx_buf_len = cfg.rx.ring_buffer_size;
+        _rx_current = 0;
+        for (uint8_t i = 1; i < _rx_buf_count; ++i) {
+            xQueueSend(_rx_free, &i, 0);
+        }
 
         _rx_config          = to_rmt_rx_config(cfg, esp_clk_apb_freq());
         _rx_config.gpio_num = rx_pin();
@@ -308,7 +546,7 @@ bool GPIOImplV2::begin(const gpio::adapter_config_t &cfg)
         dump_rmt_config(_receive_config);
 
         // Kick rmt_receive
-        err = rmt_receive(_rx_handle, _rx_buf, _rx_buf_len, &_receive_config);
+        err = rmt_receive(_rx_handle, rx_buffer(_rx_current), _rx_buf_len, &_receive_config);
         if (err != ESP_OK) {
             M5_LIB_LOGE("Failed to rmt_receive %x", err);
             return false;
@@ -351,9 +589,44 @@ m5::hal::error::error_t GPIOImplV2::writeWithTransaction(const uint8_t *data, co
     return err == ESP_OK ? m5::hal::error::error_t::OK : m5::hal::error::error_t::UNKNOWN_ERROR;
 }
 
+bool GPIOImplV2::create_encoder(const size_t idx)
+{
+    auto enc = create_rmt_encoder(_encoders[idx]);
+    if (!enc) {
+        return false;
+    }
+    _rmt_encoders.push_back(enc);
+    return true;
+}
+
+m5::hal::error::error_t GPIOImplV2::writeEncoded(const int encoder, const uint8_t *data, const size_t len,
+                                                 const uint32_t waitMs)
+{
+    if (!_tx_handle) {
+        M5_LIB_LOGE("Invalid handle");
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    if (encoder < 0 || static_cast<size_t>(encoder) >= _rmt_encoders.size() || !data || !len) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+
+    // Encoded from the payload while sending
+    auto err = rmt_transmit(_tx_handle, _rmt_encoders[encoder], data, len, &_transmit_config);
+    if (err != ESP_OK) {
+        M5_LIB_LOGE("Failed to transmit %d:%s", err, esp_err_to_name(err));
+    }
+    if (err == ESP_OK && waitMs) {
+        err = rmt_tx_wait_all_done(_tx_handle, (waitMs == portMAX_DELAY) ? -1 : waitMs);
+        if (err != ESP_OK) {
+            M5_LIB_LOGE("Failed to wait %d:%s", err, esp_err_to_name(err));
+        }
+    }
+    return err == ESP_OK ? m5::hal::error::error_t::OK : m5::hal::error::error_t::UNKNOWN_ERROR;
+}
+
 m5::hal::error::error_t GPIOImplV2::readWithTransaction(uint8_t *data, const size_t len)
 {
-    if (!_rx_handle || !_ring_buf) {
+    if (!_rx_handle || !_rx_full) {
         return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
     if (!data || len < 4) {
@@ -362,83 +635,208 @@ m5::hal::error::error_t GPIOImplV2::readWithTransaction(uint8_t *data, const siz
     }
 
     size_t max_len = len - 2;  // Top of 2 bytes is receive length
-    size_t rx_size{};
-    auto *items = static_cast<uint8_t *>(xRingbufferReceive(_ring_buf, &rx_size, pdMS_TO_TICKS(50)));
+    gpio::rmt_frame_t frame{};
+    const bool received = receiveFrame(frame, _adapter_cfg.rx.read_timeout_ms);
+    const size_t rx_size = frame.count * sizeof(rmt_symbol_word_t);
 
     memcpy(data, "\0\0", 2);
-    if (items && rx_size) {
+    if (received && rx_size) {
         uint16_t rlen = (rx_size > max_len) ? static_cast<uint16_t>(max_len) : static_cast<uint16_t>(rx_size);
         memcpy(data, &rlen, sizeof(rlen));
-        memcpy(data + 2, items, rlen);
+        memcpy(data + 2, frame.symbols, rlen);
     }
-    if (items) {
-        vRingbufferReturnItem(_ring_buf, items);
+    if (received) {
+        releaseFrame(frame);
     }
     return rx_size ? m5::hal::error::error_t::OK : m5::hal::error::error_t::TIMEOUT_ERROR;
 }
 
-void GPIOImplV2::receive_loop_task(void *)
+const uint8_t *GPIOImplV2::acquireReceived(size_t &len, const uint32_t timeout_ms)
+{
+    gpio::rmt_frame_t frame{};
+    receiveFrame(frame, timeout_ms);
+    len = frame.count * sizeof(rmt_symbol_word_t);
+    return reinterpret_cast<const uint8_t *>(frame.symbols);
+}
+
+bool GPIOImplV2::receiveFrame(gpio::rmt_frame_t &frame, const uint32_t timeout_ms)
+{
+    frame = gpio::rmt_frame_t{};
+    uint8_t idx{};
+    const TickType_t ticks = (timeout_ms == gpio::wait_forever) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+    if (!_rx_full || xQueueReceive(_rx_full, &idx, ticks) != pdTRUE) {
+        return false;
+    }
+    _rx_lent.fetch_or(1U << idx);
+    frame.symbols      = reinterpret_cast<const rmt_symbol_word_t *>(rx_buffer(idx));
+    frame.count        = _rx_len[idx] / sizeof(rmt_symbol_word_t);
+    frame.timestamp_us = _rx_stamp[idx];
+    frame.overflow     = _rx_overflow[idx];
+    return true;
+}
+
+void GPIOImplV2::releaseFrame(const gpio::rmt_frame_t &frame)
+{
+    releaseReceived(reinterpret_cast<const uint8_t *>(frame.symbols));
+}
+
+void GPIOImplV2::releaseReceived(const uint8_t *items)
+{
+    if (!_rx_free || items < _rx_pool) {
+        return;
+    }
+    const size_t offset = items - _rx_pool;
+    if (offset < static_cast<size_t>(_rx_buf_len) * _rx_buf_count && offset % _rx_buf_len == 0) {
+        const uint8_t idx = offset / _rx_buf_len;
+        const uint8_t bit = 1U << idx;
+        // Returned only once, stray or double releases would queue the buffer being received
+        if (_rx_lent.fetch_and(static_cast<uint8_t>(~bit)) & bit) {
+            xQueueSend(_rx_free, &idx, 0);
+        }
+    }
+}
+
+void GPIOImplV2::receive_loop_task(void *queue)
 {
+    auto q = static_cast<QueueHandle_t>(queue);
     for (;;) {
         callback_struct_t cs{};
-        if (xQueueReceive(_receive_queue, &cs, portMAX_DELAY) && cs.me) {
-            cs.me->receive_loop(cs.len);
+        if (xQueueReceive(q, &cs, portMAX_DELAY) != pdTRUE) {
+            continue;
         }
+        if (cs.fence) {
+            const bool stop = cs.stop;
+            xSemaphoreGive(cs.fence);  // The adapter may be destroyed from here
+            if (stop) {
+                break;
+            }
+            continue;
+        }
+        cs.me->receive_loop(cs);
     }
+    vQueueDelete(q);
+    vTaskDelete(nullptr);
 }
 
-void GPIOImplV2::receive_loop(const uint16_t received_len)
+void GPIOImplV2::receive_loop(const callback_struct_t &cs)
 {
+    const uint16_t received_len = cs.len;
+    const uint32_t latency      = static_cast<uint32_t>(esp_timer_get_time() - cs.isr_us);
+    ++_worker_stats.events;
+    _worker_stats.last_latency_us = latency;
+    if (latency > _worker_stats.max_latency_us) {
+        _worker_stats.max_latency_us = latency;
+    }
+
     xSemaphoreTake(_sem, portMAX_DELAY);
+    if (!_rx_handle) {
+        // Being destroyed
+        xSemaphoreGive(_sem);
+        return;
+    }
 
-    // Push received data to ringbuffer before restarting rmt_receive
-    if (_ring_buf && received_len > 0) {
-        if (xRingbufferSend(_ring_buf, _rx_buf, received_len, 0) != pdTRUE) {
-            M5_LIB_LOGW("Ringbuffer full, dropped %u bytes", received_len);
-        }
+    // Arm the next reception into a free buffer first, then lend the received one
+    const uint8_t filled = _rx_current;
+    uint8_t next{filled};
+    const bool lend = received_len && (xQueueReceive(_rx_free, &next, 0) == pdTRUE);
+    if (received_len && !lend) {
+        ++_rx_dropped;  // Receive into the same buffer again
+    }
+    _rx_current = next;
+    auto err    = rmt_receive(_rx_handle, rx_buffer(next), _rx_buf_len, &_receive_config);
+    if (lend) {
+        _rx_len[filled]      = received_len;
+        _rx_stamp[filled]    = cs.isr_us;
+        _rx_overflow[filled] = (received_len >= _rx_buf_len);
+        xQueueSend(_rx_full, &filled, 0);  // Never full, the number of the buffers is the same
     }
-    auto err = rmt_receive(_rx_handle, _rx_buf, _rx_buf_len, &_receive_config);
 
     xSemaphoreGive(_sem);
 
+    if (received_len && !lend) {
+        M5_LIB_LOGW("No free buffer, dropped %u bytes", received_len);
+    }
     if (err != ESP_OK) {
         M5_LIB_LOGE("Failed to rmt_receive %x", err);
     }
 }
 
-bool GPIOImplV2::createReceiveTask()
+bool GPIOImplV2::createReceiveTask(const gpio::adapter_config_t::rx_config_t::worker_config_t &wcfg)
 {
-    if (_receive_task_handle) {
+    if (_worker_queue) {
         return true;
     }
 
+    const BaseType_t core    = (wcfg.core < 0) ? tskNO_AFFINITY : wcfg.core;
+    const UBaseType_t depth = std::max<uint16_t>(wcfg.queue_depth, 1);
+    if (wcfg.dedicated) {
+        _worker_queue = xQueueCreate(depth, sizeof(callback_struct_t));
+        if (!_worker_queue) {
+            M5_LIB_LOGE("Failed to create queue");
+            return false;
+        }
+        TaskHandle_t task{};
+        if (xTaskCreatePinnedToCore(receive_loop_task, "M5UnitRmtRXd", wcfg.stack_size, _worker_queue, wcfg.priority,
+                                    &task, core) != pdPASS) {
+            M5_LIB_LOGE("Failed to create task");
+            vQueueDelete(_worker_queue);
+            _worker_queue = nullptr;
+            return false;
+        }
+        _dedicated_worker = true;
+        return true;
+    }
+
+    // Shared by all adapters, created by the first one
+    if (_receive_queue && (wcfg.core != _receive_worker_cfg.core || wcfg.priority != _receive_worker_cfg.priority ||
+                           wcfg.queue_depth != _receive_worker_cfg.queue_depth ||
+                           wcfg.stack_size != _receive_worker_cfg.stack_size)) {
+        M5_LIB_LOGW("The shared worker is already created with the other settings, which are used");
+    }
     if (!_receive_queue) {
-        _receive_queue = xQueueCreate(16, sizeof(callback_struct_t));
+        _receive_worker_cfg = wcfg;
+        _receive_queue = xQueueCreate(depth, sizeof(callback_struct_t));
         if (!_receive_queue) {
             M5_LIB_LOGE("Failed to create queue");
             return false;
         }
     }
-    auto err =
-        xTaskCreatePinnedToCore(receive_loop_task, "M5UnitRmtRX", 8192, nullptr, 2, &_receive_task_handle, PRO_CPU_NUM);
-    return (err == pdPASS) && _receive_task_handle;
+    if (!_receive_task_handle) {
+        auto err = xTaskCreatePinnedToCore(receive_loop_task, "M5UnitRmtRX", wcfg.stack_size, _receive_queue,
+                                           wcfg.priority, &_receive_task_handle, core);
+        if (err != pdPASS || !_receive_task_handle) {
+            M5_LIB_LOGE("Failed to create task");
+            return false;
+        }
+    }
+    _worker_queue = _receive_queue;
+    return true;
 }
 
 IRAM_ATTR bool GPIOImplV2::callbackReceive(rmt_channel_handle_t handle, const rmt_rx_done_event_data_t *edata,
                                            void *user_ctx)
 {
     BaseType_t high_task_wakeup{pdFALSE};
+    auto me = static_cast<GPIOImplV2 *>(user_ctx);
     callback_struct_t cs{
-        static_cast<GPIOImplV2 *>(user_ctx),
+        me,
         static_cast<uint16_t>(edata->num_symbols * sizeof(rmt_symbol_word_t)),
+        esp_timer_get_time(),
     };
     //    esp_rom_printf("ISR %u\n", (uint32_t)edata->num_symbols);
-    xQueueSendFromISR(_receive_queue, &cs, &high_task_wakeup);
+    if (xQueueSendFromISR(me->_worker_queue, &cs, &high_task_wakeup) != pdTRUE) {
+        ++me->_worker_stats.queue_overflows;
+    }
+    const UBaseType_t waiting = uxQueueMessagesWaitingFromISR(me->_worker_queue);
+    if (waiting > me->_worker_stats.queue_high_water) {
+        me->_worker_stats.queue_high_water = waiting;
+    }
     return (high_task_wakeup == pdTRUE);
 }
 
 QueueHandle_t GPIOImplV2::_receive_queue{};
 TaskHandle_t GPIOImplV2::_receive_task_handle{};
+gpio::adapter_config_t::rx_config_t::worker_config_t GPIOImplV2::_receive_worker_cfg{};
 
 //
 AdapterGPIO::AdapterGPIO(const int8_t rx_pin, const int8_t tx_pin) : AdapterGPIOBase(new GPIOImplV2(rx_pin, tx_pin))
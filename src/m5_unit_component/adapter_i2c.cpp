@@ -25,6 +25,18 @@
 namespace m5 {
 namespace unit {
 
+namespace {
+// Identity of each I2C port for the bus lock, shared by all the backends on the same port
+uint8_t i2c_port_keys[4]{};
+
+// Gets the bus lock of the port, or of the key if the port is unknown
+BusLock* get_bus_lock(const int port, const void* key)
+{
+    return (port >= 0 && port < static_cast<int>(m5::stl::size(i2c_port_keys))) ? BusLock::get(&i2c_port_keys[port])
+                                                                                 : BusLock::get(key);
+}
+}  // namespace
+
 #if defined(ARDUINO)
 
 namespace {
@@ -74,8 +86,13 @@ AdapterI2C::WireImpl::WireImpl(TwoWire& wire, const uint8_t addr, const uint32_t
     : AdapterI2C::I2CImpl(addr, clock), _wire(&wire)
 {
     uint32_t w = (&wire != &Wire);
-    _sda       = search_pin_number(idx_table[w][0]);
-    _scl       = search_pin_number(idx_table[w][1]);
+#if defined(CONFIG_IDF_TARGET_ESP32C6)
+    _bus_lock = get_bus_lock(0, _wire);  // Same as Wire
+#else
+    _bus_lock = get_bus_lock(w, _wire);  // Wire:0 Wire1:1
+#endif
+    _sda = search_pin_number(idx_table[w][0]);
+    _scl = search_pin_number(idx_table[w][1]);
     M5_LIB_LOGI("I2C SDA:%d, SCL:%d", _sda, _scl);
 }
 
@@ -93,16 +110,38 @@ bool AdapterI2C::WireImpl::end()
 }
 
 m5::hal::error::error_t AdapterI2C::WireImpl::readWithTransaction(uint8_t* data, const size_t len)
+{
+    if (!data) {
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    buffer_span_t span{data, len};
+    return readWithTransaction(&span, 1);
+}
+
+m5::hal::error::error_t AdapterI2C::WireImpl::readWithTransaction(const buffer_span_t* spans, const size_t count)
 {
     assert(_addr);
-    if (data && _wire->requestFrom(_addr, len)) {
-        auto count = std::min(len, (size_t)_wire->available());
-        for (size_t i = 0; i < count; ++i) {
-            data[i] = (uint8_t)_wire->read();
+    size_t total{};
+    for (size_t i = 0; spans && i < count; ++i) {
+        if (!spans[i].data && spans[i].len) {
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
         }
-        return (count == len) ? m5::hal::error::error_t::OK : m5::hal::error::error_t::I2C_BUS_ERROR;
+        total += spans[i].len;
     }
-    return m5::hal::error::error_t::UNKNOWN_ERROR;
+
+    if (!total) {
+        return m5::hal::error::error_t::UNKNOWN_ERROR;
+    }
+    if (_wire->requestFrom(_addr, total) != total) {
+        return m5::hal::error::error_t::I2C_BUS_ERROR;
+    }
+    // All bytes are buffered, copy them straight into each destination
+    for (size_t i = 0; i < count; ++i) {
+        if (spans[i].len && _wire->readBytes(spans[i].data, spans[i].len) != spans[i].len) {
+            return m5::hal::error::error_t::I2C_BUS_ERROR;
+        }
+    }
+    return m5::hal::error::error_t::OK;
 }
 
 m5::hal::error::error_t AdapterI2C::WireImpl::writeWithTransaction(const uint8_t* data, const size_t len,
@@ -148,6 +187,52 @@ m5::hal::error::error_t AdapterI2C::WireImpl::writeWithTransaction(const uint16_
     return (ret == 0) ? m5::hal::error::error_t::OK : m5::hal::error::error_t::I2C_BUS_ERROR;
 }
 
+m5::hal::error::error_t AdapterI2C::WireImpl::executeTransaction(const transaction::op_t* ops, const size_t count)
+{
+    if (!ops && count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    assert(_addr);
+    _wire->setClock(_clock);  // Once for all operations
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto& op = ops[i];
+        if (op.type == transaction::OpType::Delay) {
+            m5::utility::delay(op.delay_ms);
+            continue;
+        }
+        if (op.type == transaction::OpType::Read) {
+            if (!op.rx || !op.len) {
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+            }
+            if (_wire->requestFrom(_addr, op.len) != op.len) {
+                return m5::hal::error::error_t::I2C_BUS_ERROR;
+            }
+            if (_wire->readBytes(op.rx, op.len) != op.len) {
+                return m5::hal::error::error_t::I2C_BUS_ERROR;
+            }
+            continue;
+        }
+
+        _wire->beginTransmission(_addr);
+        if (op.type == transaction::OpType::WriteReg16) {
+            _wire->write(static_cast<uint8_t>(op.reg >> 8));
+        }
+        if (op.type != transaction::OpType::Write) {
+            _wire->write(static_cast<uint8_t>(op.reg & 0xFF));
+        }
+        if (op.tx && op.len) {
+            _wire->write(op.tx, op.len);
+        }
+        auto ret = _wire->endTransmission(op.stop);
+        if (ret) {
+            M5_LIB_LOGE("%d endTransmission stop:%d", ret, op.stop);
+            return m5::hal::error::error_t::I2C_BUS_ERROR;
+        }
+    }
+    return m5::hal::error::error_t::OK;
+}
+
 AdapterI2C::I2CImpl* AdapterI2C::WireImpl::duplicate(const uint8_t addr)
 {
     return new WireImpl(*_wire, addr, _clock);
@@ -184,6 +269,7 @@ m5::hal::error::error_t AdapterI2C::WireImpl::write_with_transaction(const uint8
 AdapterI2C::BusImpl::BusImpl(m5::hal::bus::Bus* bus, const uint8_t addr, const uint32_t clock)
     : AdapterI2C::I2CImpl(addr, clock), _bus(bus)
 {
+    _bus_lock            = BusLock::get(_bus);
     _access_cfg.i2c_addr = addr;
     _access_cfg.freq     = clock;
     if (_bus && _bus->getBusType() == m5::hal::types::bus_type_t::I2C) {
@@ -294,6 +380,64 @@ m5::hal::error::error_t AdapterI2C::BusImpl::writeWithTransaction(const uint16_t
     return m5::hal::error::error_t::INVALID_ARGUMENT;
 }
 
+m5::hal::error::error_t AdapterI2C::BusImpl::executeTransaction(const transaction::op_t* ops, const size_t count)
+{
+    if (!_bus || (!ops && count)) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+
+    // All operations in one access
+    auto acc = _bus->beginAccess(_access_cfg);
+    if (!acc) {
+        return acc.error();
+    }
+    auto trans  = acc.value();
+    auto result = m5::hal::error::error_t::OK;
+    for (size_t i = 0; result == m5::hal::error::error_t::OK && i < count; ++i) {
+        const auto& op = ops[i];
+        if (op.type == transaction::OpType::Delay) {
+            m5::utility::delay(op.delay_ms);
+            continue;
+        }
+        if (op.type == transaction::OpType::Read) {
+            if (!op.rx || !op.len) {
+                result = m5::hal::error::error_t::INVALID_ARGUMENT;
+                break;
+            }
+            auto r = trans->startRead().and_then([&trans, &op]() {
+                return trans->readLastNack(op.rx, op.len).and_then([&trans](size_t&&) { return trans->stop(); });
+            });
+            result = r ? m5::hal::error::error_t::OK : r.error();
+            continue;
+        }
+
+        uint8_t reg[2]{};
+        size_t rlen{};
+        if (op.type == transaction::OpType::WriteReg8) {
+            reg[0] = static_cast<uint8_t>(op.reg);
+            rlen   = 1;
+        } else if (op.type == transaction::OpType::WriteReg16) {
+            reg[0] = static_cast<uint8_t>(op.reg >> 8);
+            reg[1] = static_cast<uint8_t>(op.reg & 0xFF);
+            rlen   = 2;
+        }
+        auto r = trans->startWrite().and_then([&trans, &op, &reg, &rlen]() {
+            return (rlen ? trans->write(reg, rlen) : m5::stl::expected<size_t, m5::hal::error::error_t>((size_t)0UL))
+                .and_then([&trans, &op](size_t&&) {
+                    return (op.tx && op.len) ? trans->write(op.tx, op.len)
+                                             : m5::stl::expected<size_t, m5::hal::error::error_t>((size_t)0UL);
+                })
+                .and_then([&trans, &op](size_t&&) {
+                    return op.stop ? trans->stop() : m5::stl::expected<void, m5::hal::error::error_t>();
+                });
+        });
+        result = r ? m5::hal::error::error_t::OK : r.error();
+    }
+    // Clean-up must be called
+    auto eresult = this->_bus->endAccess(std::move(trans));
+    return (result != m5::hal::error::error_t::OK) ? result : eresult;
+}
+
 m5::hal::error::error_t AdapterI2C::BusImpl::generalCall(const uint8_t* data, const size_t len)
 {
     m5::hal::bus::I2CMasterAccessConfig gcfg = _access_cfg;
@@ -355,6 +499,18 @@ AdapterI2C::ESPIDFMasterBusImpl::ESPIDFMasterBusImpl(i2c_master_bus_handle_t bus
                                                      const uint32_t clock)
     : AdapterI2C::I2CImpl(addr, clock), _bus(bus)
 {
+    int port{-1};
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+    // Find the port of the handle
+    for (int p = 0; p < static_cast<int>(m5::stl::size(i2c_port_keys)); ++p) {
+        i2c_master_bus_handle_t h{};
+        if (i2c_master_get_bus_handle(p, &h) == ESP_OK && h == _bus) {
+            port = p;
+            break;
+        }
+    }
+#endif
+    _bus_lock = get_bus_lock(port, _bus);
 }
 
 bool AdapterI2C::ESPIDFMasterBusImpl::begin()
@@ -493,6 +649,83 @@ m5::hal::error::error_t AdapterI2C::ESPIDFMasterBusImpl::writeWithTransaction(co
     return transmit(tx.data(), tx.size());
 }
 
+m5::hal::error::error_t AdapterI2C::ESPIDFMasterBusImpl::executeTransaction(const transaction::op_t* ops,
+                                                                            const size_t count)
+{
+    if (!ops && count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    auto err = ensure_device();
+    if (err != m5::hal::error::error_t::OK) {
+        return err;
+    }
+    _pending_write.clear();
+
+    // The driver issues STOP at the end of each call, so repeated START is only available as write + read
+    for (size_t i = 0; i < count; ++i) {
+        if (!ops[i].stop && ops[i].type != transaction::OpType::Read && ops[i].type != transaction::OpType::Delay &&
+            (i + 1 >= count || ops[i + 1].type != transaction::OpType::Read)) {
+            M5_LIB_LOGE("Repeated START is supported only before read");
+            return m5::hal::error::error_t::NOT_IMPLEMENTED;
+        }
+    }
+
+    std::vector<uint8_t> tx{};
+    for (size_t i = 0; i < count; ++i) {
+        const auto& op = ops[i];
+        if (op.type == transaction::OpType::Delay) {
+            m5::utility::delay(op.delay_ms);
+            continue;
+        }
+        if (op.type == transaction::OpType::Read) {
+            if (!op.rx || !op.len) {
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+            }
+            err = to_i2c_error(i2c_master_receive(_dev, op.rx, op.len, default_i2c_timeout_ms));
+            if (err != m5::hal::error::error_t::OK) {
+                return err;
+            }
+            continue;
+        }
+        if (!op.tx && op.len) {
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+
+        // Register and data are sent in one buffer
+        const uint8_t* wbuf{op.tx};
+        size_t wlen{op.len};
+        if (op.type != transaction::OpType::Write) {
+            tx.clear();
+            if (op.type == transaction::OpType::WriteReg16) {
+                tx.push_back(static_cast<uint8_t>(op.reg >> 8));
+            }
+            tx.push_back(static_cast<uint8_t>(op.reg & 0xFF));
+            if (op.tx && op.len) {
+                tx.insert(tx.end(), op.tx, op.tx + op.len);
+            }
+            wbuf = tx.data();
+            wlen = tx.size();
+        }
+
+        const transaction::op_t* next = (i + 1 < count) ? &ops[i + 1] : nullptr;
+        if (!op.stop && next && next->type == transaction::OpType::Read) {
+            if (!next->rx || !next->len) {
+                return m5::hal::error::error_t::INVALID_ARGUMENT;
+            }
+            err = to_i2c_error(
+                i2c_master_transmit_receive(_dev, wbuf, wlen, next->rx, next->len, default_i2c_timeout_ms));
+            ++i;  // The read is done
+        } else {
+            err = wlen ? to_i2c_error(i2c_master_transmit(_dev, wbuf, wlen, default_i2c_timeout_ms))
+                       : m5::hal::error::error_t::OK;
+        }
+        if (err != m5::hal::error::error_t::OK) {
+            return err;
+        }
+    }
+    return m5::hal::error::error_t::OK;
+}
+
 m5::hal::error::error_t AdapterI2C::ESPIDFMasterBusImpl::generalCall(const uint8_t* data, const size_t len)
 {
     if (!_bus || (!data && len)) {
@@ -536,6 +769,7 @@ AdapterI2C::ESPIDFLegacyBusImpl::ESPIDFLegacyBusImpl(const i2c_port_t port, cons
     // via i2c_set_period. Each unit caches its own _high/_low, so units with different clocks on the
     // same port do not clobber each other.
     apply_clock();
+    _bus_lock = get_bus_lock(_port < I2C_NUM_MAX ? _port : -1, nullptr);
 }
 
 void AdapterI2C::ESPIDFLegacyBusImpl::apply_clock()
@@ -586,19 +820,38 @@ AdapterI2C::I2CImpl* AdapterI2C::ESPIDFLegacyBusImpl::duplicate(const uint8_t ad
 
 m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::readWithTransaction(uint8_t* data, const size_t len)
 {
-    if (!data || !len) {
+    buffer_span_t span{data, len};
+    return readWithTransaction(&span, 1);
+}
+
+m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::readWithTransaction(const buffer_span_t* spans,
+                                                                             const size_t count)
+{
+    size_t total{};
+    for (size_t i = 0; spans && i < count; ++i) {
+        if (!spans[i].data && spans[i].len) {
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+        total += spans[i].len;
+    }
+    if (!total) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
+
     if (_high > 0 && _low > 0) {
         i2c_set_period(_port, _high, _low);
     }
     i2c_cmd_handle_t cmd = i2c_cmd_link_create();
     i2c_master_start(cmd);
     i2c_master_write_byte(cmd, static_cast<uint8_t>((_addr << 1) | I2C_MASTER_READ), true);
-    if (len > 1) {
-        i2c_master_read(cmd, data, len - 1, I2C_MASTER_ACK);
+    // The driver receives directly into each destination, NACK only the last byte
+    size_t remain{total};
+    for (size_t i = 0; i < count; ++i) {
+        if (spans[i].len) {
+            remain -= spans[i].len;
+            i2c_master_read(cmd, spans[i].data, spans[i].len, remain ? I2C_MASTER_ACK : I2C_MASTER_LAST_NACK);
+        }
     }
-    i2c_master_read_byte(cmd, data + len - 1, I2C_MASTER_NACK);
     i2c_master_stop(cmd);
     esp_err_t err = i2c_master_cmd_begin(_port, cmd, pdMS_TO_TICKS(1000));
     i2c_cmd_link_delete(cmd);
@@ -674,6 +927,79 @@ m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::writeWithTransaction(co
     return (err == ESP_OK) ? m5::hal::error::error_t::OK : m5::hal::error::error_t::I2C_BUS_ERROR;
 }
 
+m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::executeTransaction(const transaction::op_t* ops,
+                                                                            const size_t count)
+{
+    if (!ops && count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    if (_high > 0 && _low > 0) {
+        i2c_set_period(_port, _high, _low);
+    }
+
+    // Operations are queued into a single command link, split only where a delay is required
+    i2c_cmd_handle_t cmd{};
+    esp_err_t err{ESP_OK};
+    auto flush = [this, &cmd, &err]() {
+        if (cmd) {
+            if (err == ESP_OK) {
+                err = i2c_master_cmd_begin(_port, cmd, pdMS_TO_TICKS(1000));
+            }
+            i2c_cmd_link_delete(cmd);
+            cmd = nullptr;
+        }
+    };
+
+    for (size_t i = 0; err == ESP_OK && i < count; ++i) {
+        const auto& op = ops[i];
+        if (op.type == transaction::OpType::Delay) {
+            flush();
+            m5::utility::delay(op.delay_ms);
+            continue;
+        }
+        if (op.type == transaction::OpType::Read && (!op.rx || !op.len)) {
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        if (!cmd && !(cmd = i2c_cmd_link_create())) {
+            err = ESP_ERR_NO_MEM;
+            break;
+        }
+
+        i2c_master_start(cmd);  // START or repeated START
+        if (op.type == transaction::OpType::Read) {
+            i2c_master_write_byte(cmd, static_cast<uint8_t>((_addr << 1) | I2C_MASTER_READ), true);
+            i2c_master_read(cmd, op.rx, op.len, I2C_MASTER_LAST_NACK);
+            i2c_master_stop(cmd);
+            continue;
+        }
+        i2c_master_write_byte(cmd, static_cast<uint8_t>((_addr << 1) | I2C_MASTER_WRITE), true);
+        // Register is written by value, as the command link refers to the write buffer until executed
+        if (op.type == transaction::OpType::WriteReg16) {
+            i2c_master_write_byte(cmd, static_cast<uint8_t>(op.reg >> 8), true);
+        }
+        if (op.type != transaction::OpType::Write) {
+            i2c_master_write_byte(cmd, static_cast<uint8_t>(op.reg & 0xFF), true);
+        }
+        if (op.tx && op.len) {
+            i2c_master_write(cmd, op.tx, op.len, true);
+        }
+        if (op.stop) {
+            i2c_master_stop(cmd);
+        }
+    }
+    flush();
+
+    switch (err) {
+        case ESP_OK:
+            return m5::hal::error::error_t::OK;
+        case ESP_ERR_INVALID_ARG:
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        default:
+            return m5::hal::error::error_t::I2C_BUS_ERROR;
+    }
+}
+
 m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::generalCall(const uint8_t* data, const size_t len)
 {
     return write_with_transaction(0x00, data, len, true);
@@ -692,6 +1018,7 @@ m5::hal::error::error_t AdapterI2C::ESPIDFLegacyBusImpl::wakeup()
 AdapterI2C::I2CClassImpl::I2CClassImpl(m5::I2C_Class& i2c, const uint8_t addr, const uint32_t clock)
     : AdapterI2C::I2CImpl(addr, clock), _i2c(&i2c)
 {
+    _bus_lock = get_bus_lock(_i2c->getPort(), _i2c);
     _sda = _i2c->getSDA();
     _scl = _i2c->getSCL();
     M5_LIB_LOGI("I2C_Class SDA:%d, SCL:%d", _sda, _scl);
@@ -709,16 +1036,41 @@ bool AdapterI2C::I2CClassImpl::end()
 
 m5::hal::error::error_t AdapterI2C::I2CClassImpl::readWithTransaction(uint8_t* data, const size_t len)
 {
-    assert(_addr);
     if (!data) {
         return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
+    buffer_span_t span{data, len};
+    return readWithTransaction(&span, 1);
+}
+
+m5::hal::error::error_t AdapterI2C::I2CClassImpl::readWithTransaction(const buffer_span_t* spans, const size_t count)
+{
+    assert(_addr);
+    size_t total{};
+    for (size_t i = 0; spans && i < count; ++i) {
+        if (!spans[i].data && spans[i].len) {
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+        total += spans[i].len;
+    }
+    if (!spans || !count) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+
     bool started = _in_transaction ? _i2c->restart(_addr, true, _clock) : _i2c->start(_addr, true, _clock);
     if (!started) {
         _in_transaction = false;
         return m5::hal::error::error_t::I2C_BUS_ERROR;
     }
-    bool ok = _i2c->read(data, len, true);
+    // Read directly into each destination, NACK only the last byte
+    bool ok{true};
+    size_t remain{total};
+    for (size_t i = 0; ok && i < count; ++i) {
+        if (spans[i].len) {
+            remain -= spans[i].len;
+            ok = _i2c->read(spans[i].data, spans[i].len, remain == 0);
+        }
+    }
     _i2c->stop();
     _in_transaction = false;
     return ok ? m5::hal::error::error_t::OK : m5::hal::error::error_t::I2C_BUS_ERROR;
@@ -839,6 +1191,11 @@ m5::hal::error::error_t AdapterI2C::I2CClassImpl::readWithTransaction(uint8_t*,
     return m5::hal::error::error_t::UNKNOWN_ERROR;
 }
 
+m5::hal::error::error_t AdapterI2C::I2CClassImpl::readWithTransaction(const buffer_span_t*, const size_t)
+{
+    return m5::hal::error::error_t::UNKNOWN_ERROR;
+}
+
 m5::hal::error::error_t AdapterI2C::I2CClassImpl::writeWithTransaction(const uint8_t*, const size_t, const uint32_t)
 {
     return m5::hal::error::error_t::UNKNOWN_ERROR;
@@ -95,6 +95,11 @@ public:
         {
             return m5::hal::error::error_t::UNKNOWN_ERROR;
         }
+        // Execute the operations one by one, the write without STOP is followed by repeated START
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count) override
+        {
+            return execute_operations(ops, count, true);
+        }
 
         //
         virtual I2CImpl* duplicate(const uint8_t addr)
@@ -158,6 +163,7 @@ public:
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count) override;
         virtual m5::hal::error::error_t generalCall(const uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t wakeup() override;
 
@@ -199,12 +205,14 @@ public:
         virtual bool end() override;
         virtual I2CImpl* duplicate(const uint8_t addr) override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
+        virtual m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count) override;
         virtual m5::hal::error::error_t generalCall(const uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t wakeup() override;
 
@@ -244,12 +252,14 @@ public:
         virtual bool begin() override;
         virtual bool end() override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
+        virtual m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count) override;
         virtual I2CImpl* duplicate(const uint8_t addr) override;
         virtual m5::hal::error::error_t generalCall(const uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t wakeup() override;
@@ -311,6 +321,7 @@ public:
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t executeTransaction(const transaction::op_t* ops, const size_t count) override;
         virtual m5::hal::error::error_t generalCall(const uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t wakeup() override;
 
@@ -346,6 +357,7 @@ public:
         virtual bool begin() override;
         virtual bool end() override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
+        virtual m5::hal::error::error_t readWithTransaction(const buffer_span_t* spans, const size_t count) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t* data, const size_t len,
@@ -428,12 +440,20 @@ public:
     ///@{
     inline bool begin()
     {
+        bus_lock_guard lock(impl()->busLock());
         return impl()->begin();
     }
     inline bool end()
     {
+        bus_lock_guard lock(impl()->busLock());
         return impl()->end();
     }
+    //! @brief Check that the device acknowledges its address
+    inline m5::hal::error::error_t wakeup()
+    {
+        bus_lock_guard lock(impl()->busLock());
+        return impl()->wakeup();
+    }
     bool pushPin();
     bool popPin();
     ///@}
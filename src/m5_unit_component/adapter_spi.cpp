@@ -12,20 +12,70 @@
 #if defined(ESP_PLATFORM)
 #include <driver/gpio.h>
 #include <freertos/FreeRTOS.h>
+#include <esp_heap_caps.h>
+#include <esp_memory_utils.h>
 #endif
 #include <M5HAL.hpp>
 #include <M5Utility.hpp>
 #include <cassert>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace m5 {
 namespace unit {
 
+namespace {
+constexpr size_t merged_write_size{32};  // Register and data up to this are sent in one transfer
+}  // namespace
+
+m5::hal::error::error_t AdapterSPI::SPIImpl::write_register(const uint8_t* reg, const size_t rlen,
+                                                            const uint8_t* data, const size_t len)
+{
+    if (data && len && rlen + len <= merged_write_size) {
+        uint8_t buf[merged_write_size];
+        std::memcpy(buf, reg, rlen);
+        std::memcpy(buf + rlen, data, len);
+        return writeWithTransaction(buf, rlen + len, 0);
+    }
+    auto ret = writeWithTransaction(reg, rlen, 0);
+    if (data && len && ret == m5::hal::error::error_t::OK) {
+        ret = writeWithTransaction(data, len, 0);
+    }
+    return ret;
+}
+
 #if defined(ARDUINO)
-uint32_t AdapterSPI::SPIClassImpl::transaction_count{};
+struct AdapterSPI::SPIClassImpl::host_state_t {
+    const SPIClass* spi{};
+    std::atomic<const SPIClassImpl*> owner{};  // Device in transaction
+    uint32_t depth{};                          // Accessed by the owner only
+};
+
+namespace {
+std::mutex host_registry_mutex{};
+std::vector<std::unique_ptr<AdapterSPI::SPIClassImpl::host_state_t>> host_registry{};
+
+AdapterSPI::SPIClassImpl::host_state_t* get_host_state(const SPIClass* spi)
+{
+    std::lock_guard<std::mutex> lock(host_registry_mutex);
+    for (auto&& hs : host_registry) {
+        if (hs->spi == spi) {
+            return hs.get();
+        }
+    }
+    host_registry.emplace_back(new AdapterSPI::SPIClassImpl::host_state_t());
+    host_registry.back()->spi = spi;
+    return host_registry.back().get();
+}
+}  // namespace
 
 AdapterSPI::SPIClassImpl::SPIClassImpl(SPIClass& spi, const SPISettings& settings, const gpio_num_t cs)
-    : AdapterSPI::SPIImpl(cs), _spi(&spi), _settings{settings}
+    : AdapterSPI::SPIImpl(cs), _spi(&spi), _settings{settings}, _host{get_host_state(&spi)}
 {
+    _bus_lock = BusLock::get(_spi);
     if (_cs != GPIO_NUM_NC) {
         gpio_set_direction(_cs, GPIO_MODE_OUTPUT);
         gpio_set_level(_cs, 1);  // Idle high
@@ -34,26 +84,41 @@ AdapterSPI::SPIClassImpl::SPIClassImpl(SPIClass& spi, const SPISettings& setting
 
 void AdapterSPI::SPIClassImpl::beginTransaction()
 {
-    if (transaction_count++ == 0) {
+    // Lock-free: the tasks are already serialized by the bus lock
+    const SPIClassImpl* expected{};
+    if (_host->owner.compare_exchange_strong(expected, this, std::memory_order_acquire)) {
+        _host->depth = 1;
         _spi->beginTransaction(_settings);
         if (cs_pin() != GPIO_NUM_NC) {
             gpio_set_level(cs_pin(), 0);
         }
-    } else {
-        M5_LIB_LOGE("Don't nest!");
+        return;
+    }
+    if (expected == this) {
+        // Counted even if not allowed, to keep begin/end balanced
+        ++_host->depth;
+        if (!_nesting) {
+            M5_LIB_LOGE("Don't nest!");
+        }
+        return;
     }
+    M5_LIB_LOGE("Another device on the host is in transaction");
 }
 
 void AdapterSPI::SPIClassImpl::endTransaction()
 {
-    if (transaction_count && --transaction_count == 0) {
-        if (cs_pin() != GPIO_NUM_NC) {
-            gpio_set_level(cs_pin(), 1);
-        }
-        _spi->endTransaction();
-    } else {
-        M5_LIB_LOGE("Don't nest!");
+    if (_host->owner.load(std::memory_order_relaxed) != this || !_host->depth) {
+        M5_LIB_LOGE("Not in transaction");
+        return;
+    }
+    if (--_host->depth) {
+        return;
+    }
+    if (cs_pin() != GPIO_NUM_NC) {
+        gpio_set_level(cs_pin(), 1);
     }
+    _spi->endTransaction();
+    _host->owner.store(nullptr, std::memory_order_release);
 }
 
 m5::hal::error::error_t AdapterSPI::SPIClassImpl::readWithTransaction(uint8_t* data, const size_t len)
@@ -86,22 +151,34 @@ m5::hal::error::error_t AdapterSPI::SPIClassImpl::writeWithTransaction(const uin
 m5::hal::error::error_t AdapterSPI::SPIClassImpl::writeWithTransaction(const uint8_t reg, const uint8_t* data,
                                                                        const size_t len, const uint32_t)
 {
-    auto ret = writeWithTransaction(&reg, 1, 0);
-    if (data && len && ret == m5::hal::error::error_t::OK) {
-        ret = writeWithTransaction(data, len, 0);
-    }
-    return ret;
+    return write_register(&reg, 1, data, len);
 }
 
 m5::hal::error::error_t AdapterSPI::SPIClassImpl::writeWithTransaction(const uint16_t reg, const uint8_t* data,
                                                                        const size_t len, const uint32_t)
 {
     m5::types::big_uint16_t r(reg);
-    auto ret = writeWithTransaction(r.data(), r.size(), 0);
-    if (data && len && ret == m5::hal::error::error_t::OK) {
-        ret = writeWithTransaction(data, len, 0);
+    return write_register(r.data(), r.size(), data, len);
+}
+
+m5::hal::error::error_t AdapterSPI::SPIClassImpl::transferWithTransaction(const uint8_t* tx, uint8_t* rx,
+                                                                          const size_t len)
+{
+    if (!len || (!tx && !rx)) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
     }
-    return ret;
+    _spi->transferBytes(tx, rx, len);
+    return m5::hal::error::error_t::OK;
+}
+
+m5::hal::error::error_t AdapterSPI::SPIClassImpl::queueTransfer(const uint8_t* tx, uint8_t* rx, const size_t len,
+                                                                const uint32_t /* unused */)
+{
+    if (!len) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    _spi->transferBytes(tx, rx, len);
+    return m5::hal::error::error_t::OK;
 }
 
 AdapterSPI::AdapterSPI(SPIClass& spi, const SPISettings& settings, const gpio_num_t cs)
@@ -127,64 +204,163 @@ m5::hal::error::error_t to_spi_error(const esp_err_t err)
             return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
 }
+
+constexpr size_t fifo_transfer_size{64};       // Maximum length of one transaction without DMA
+constexpr size_t dma_buffer_alignment{64};     // Covers the cache line size of the targets
+constexpr size_t interrupt_transfer_size{64};  // In DMA mode, longer transfers yield the CPU while waiting
+
+inline TickType_t to_ticks(const uint32_t ms)
+{
+    return (ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+}
+
+// Can the buffer be handed to the DMA as is?
+inline bool is_dma_ready(const void* p, const size_t len, const bool rx)
+{
+    return esp_ptr_dma_capable(p) && ((reinterpret_cast<uintptr_t>(p) & 3) == 0) && (!rx || (len & 3) == 0);
+}
 }  // namespace
 
-AdapterSPI::ESPIDFImpl::ESPIDFImpl(spi_device_handle_t handle, const gpio_num_t cs)
-    : AdapterSPI::SPIImpl(), _handle(handle), _cs(cs)
+AdapterSPI::ESPIDFImpl::ESPIDFImpl(spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs)
+    : AdapterSPI::SPIImpl(cs), _handle(handle), _hardware_cs(hardware_cs)
 {
-    if (_cs != GPIO_NUM_NC) {
+    // The driver arbitrates the devices on the same host, so the lock covers the tasks using this device
+    _bus_lock = BusLock::get(_handle);
+    // Do not touch the pin routed to the peripheral
+    if (!_hardware_cs && _cs != GPIO_NUM_NC) {
         gpio_set_direction(_cs, GPIO_MODE_OUTPUT);
         gpio_set_level(_cs, 1);  // Idle high
     }
 }
 
+AdapterSPI::ESPIDFImpl::~ESPIDFImpl()
+{
+    drain_queue();
+    release_dma_buffer();
+}
+
+void AdapterSPI::ESPIDFImpl::release_dma_buffer()
+{
+    heap_caps_free(_dma_tx);
+    heap_caps_free(_dma_rx);
+    _dma_tx   = nullptr;
+    _dma_rx   = nullptr;
+    _dma_size = 0;
+}
+
+bool AdapterSPI::ESPIDFImpl::setDMA(const bool enable, const size_t max_transfer)
+{
+    drain_queue();
+    if (!enable) {
+        release_dma_buffer();
+        _dma = false;
+        return true;
+    }
+    if (max_transfer <= 4) {
+        M5_LIB_LOGE("Invalid max_transfer %zu", max_transfer);
+        return false;
+    }
+    if (_dma && _dma_size == max_transfer) {
+        return true;
+    }
+    release_dma_buffer();
+    _dma = false;
+
+    // Rounded up so that RX length can be a multiple of 4
+    const size_t sz = (max_transfer + 3) & ~static_cast<size_t>(3);
+    _dma_tx         = static_cast<uint8_t*>(heap_caps_aligned_alloc(dma_buffer_alignment, sz, MALLOC_CAP_DMA));
+    _dma_rx         = static_cast<uint8_t*>(heap_caps_aligned_alloc(dma_buffer_alignment, sz, MALLOC_CAP_DMA));
+    if (!_dma_tx || !_dma_rx) {
+        M5_LIB_LOGE("Failed to allocate DMA buffer %zu", sz);
+        release_dma_buffer();
+        return false;
+    }
+    _dma_size = max_transfer;
+    _dma      = true;
+    return true;
+}
+
 void AdapterSPI::ESPIDFImpl::beginTransaction()
 {
-    if (_in_transaction) {
-        M5_LIB_LOGE("Don't nest!");
+    if (_depth) {
+        // Counted even if not allowed, to keep begin/end balanced
+        ++_depth;
+        if (!_nesting) {
+            M5_LIB_LOGE("Don't nest!");
+        }
         return;
     }
-    _in_transaction = true;
+    _depth = 1;
     spi_device_acquire_bus(_handle, portMAX_DELAY);
-    if (_cs != GPIO_NUM_NC) {
+    if (!_hardware_cs && _cs != GPIO_NUM_NC) {
         gpio_set_level(_cs, 0);
     }
 }
 
 void AdapterSPI::ESPIDFImpl::endTransaction()
 {
-    if (!_in_transaction) {
-        M5_LIB_LOGE("Don't nest!");
+    if (!_depth) {
+        M5_LIB_LOGE("Not in transaction");
         return;
     }
-    if (_cs != GPIO_NUM_NC) {
+    if (--_depth) {
+        return;
+    }
+    drain_queue();  // Keep CS asserted until the queued transfers complete
+    if (!_hardware_cs && _cs != GPIO_NUM_NC) {
         gpio_set_level(_cs, 1);
     }
+    // Hardware CS kept active by SPI_TRANS_CS_KEEP_ACTIVE is released with the bus
     spi_device_release_bus(_handle);
-    _in_transaction = false;
 }
 
 m5::hal::error::error_t AdapterSPI::ESPIDFImpl::do_transmit(const uint8_t* tx, uint8_t* rx, const size_t len)
 {
-    const uint8_t* tp = tx;
-    uint8_t* rp       = rx;
-    size_t remain     = len;
+    // Polling transmit cannot be used while queued transfers are pending
+    auto ret = drain_queue();
+    if (ret != m5::hal::error::error_t::OK) {
+        return ret;
+    }
+
+    const uint8_t* tp  = tx;
+    uint8_t* rp        = rx;
+    size_t remain      = len;
+    const size_t chunk = _dma ? _dma_size : fifo_transfer_size;
     while (remain) {
-        const size_t n = (remain > 64) ? 64 : remain;
+        const size_t n = (remain > chunk) ? chunk : remain;
         spi_transaction_t t{};
         t.length = n * 8;  // In bits
+        bool bounce_rx{};
         if (n <= 4) {
             // Inline 4-byte path: no DMA buffer required (always safe)
             t.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
             for (size_t i = 0; i < n; ++i) {
                 t.tx_data[i] = tp ? tp[i] : 0xFF;  // Send 0xFF dummy on read (matches Arduino)
             }
-        } else {
+        } else if (!_dma) {
             // 4 < n <= 64: FIFO via DMA-disabled bus accepts stack buffers
             t.tx_buffer = tp;  // nullptr -> driver sends zeros
             t.rx_buffer = rp;
+        } else {
+            // DMA: Use the caller memory as is if possible, otherwise via the bounce buffers
+            if (tp) {
+                if (is_dma_ready(tp, n, false)) {
+                    t.tx_buffer = tp;
+                } else {
+                    std::memcpy(_dma_tx, tp, n);
+                    t.tx_buffer = _dma_tx;
+                }
+            }
+            if (rp) {
+                bounce_rx   = !is_dma_ready(rp, n, true);
+                t.rx_buffer = bounce_rx ? _dma_rx : rp;
+            }
+        }
+        if (_hardware_cs && _depth) {
+            t.flags |= SPI_TRANS_CS_KEEP_ACTIVE;  // Hold CS until endTransaction (the bus is acquired)
         }
-        const esp_err_t err = spi_device_polling_transmit(_handle, &t);
+        const esp_err_t err = (_dma && n > interrupt_transfer_size) ? spi_device_transmit(_handle, &t)
+                                                                    : spi_device_polling_transmit(_handle, &t);
         if (err != ESP_OK) {
             return to_spi_error(err);
         }
@@ -192,6 +368,8 @@ m5::hal::error::error_t AdapterSPI::ESPIDFImpl::do_transmit(const uint8_t* tx, u
             for (size_t i = 0; i < n; ++i) {
                 rp[i] = t.rx_data[i];
             }
+        } else if (bounce_rx) {
+            std::memcpy(rp, _dma_rx, n);
         }
         if (tp) {
             tp += n;
@@ -221,26 +399,110 @@ m5::hal::error::error_t AdapterSPI::ESPIDFImpl::writeWithTransaction(const uint8
 m5::hal::error::error_t AdapterSPI::ESPIDFImpl::writeWithTransaction(const uint8_t reg, const uint8_t* data,
                                                                      const size_t len, const uint32_t /* unused */)
 {
-    auto ret = do_transmit(&reg, nullptr, 1);
-    if (data && len && ret == m5::hal::error::error_t::OK) {
-        ret = do_transmit(data, nullptr, len);
-    }
-    return ret;
+    return write_register(&reg, 1, data, len);
 }
 
 m5::hal::error::error_t AdapterSPI::ESPIDFImpl::writeWithTransaction(const uint16_t reg, const uint8_t* data,
                                                                      const size_t len, const uint32_t /* unused */)
 {
     m5::types::big_uint16_t r(reg);
-    auto ret = do_transmit(r.data(), nullptr, r.size());
-    if (data && len && ret == m5::hal::error::error_t::OK) {
-        ret = do_transmit(data, nullptr, len);
+    return write_register(r.data(), r.size(), data, len);
+}
+
+m5::hal::error::error_t AdapterSPI::ESPIDFImpl::transferWithTransaction(const uint8_t* tx, uint8_t* rx,
+                                                                        const size_t len)
+{
+    if (!len || (!tx && !rx)) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    return do_transmit(tx, rx, len);
+}
+
+bool AdapterSPI::ESPIDFImpl::setQueueDepth(const uint8_t depth)
+{
+    if (!depth || depth > MAX_QUEUE_DEPTH) {
+        M5_LIB_LOGE("Invalid depth %u", depth);
+        return false;
+    }
+    drain_queue();
+    _queue_depth = depth;
+    return true;
+}
+
+m5::hal::error::error_t AdapterSPI::ESPIDFImpl::queueTransfer(const uint8_t* tx, uint8_t* rx, const size_t len,
+                                                              const uint32_t timeout_ms)
+{
+    if (!len || len > (_dma ? _dma_size : fifo_transfer_size)) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    // Wait for the oldest if no free slot
+    if (_queue_count >= _queue_depth) {
+        auto ret = waitTransfer(timeout_ms);
+        if (ret != m5::hal::error::error_t::OK) {
+            return ret;
+        }
+    }
+
+    auto& q        = _queue[(_queue_head + _queue_count) % MAX_QUEUE_DEPTH];
+    q              = queued_transfer_t{};
+    q.trans.length = len * 8;  // In bits
+    if (len <= 4) {
+        q.trans.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+        for (size_t i = 0; i < len; ++i) {
+            q.trans.tx_data[i] = tx ? tx[i] : 0xFF;
+        }
+        q.rx = rx;
+    } else {
+        // The driver copies the buffers that are not DMA capable in DMA mode
+        q.trans.tx_buffer = tx;
+        q.trans.rx_buffer = rx;
+    }
+    if (_hardware_cs && _depth) {
+        q.trans.flags |= SPI_TRANS_CS_KEEP_ACTIVE;
+    }
+    const esp_err_t err = spi_device_queue_trans(_handle, &q.trans, to_ticks(timeout_ms));
+    if (err != ESP_OK) {
+        return to_spi_error(err);
+    }
+    ++_queue_count;
+    return m5::hal::error::error_t::OK;
+}
+
+m5::hal::error::error_t AdapterSPI::ESPIDFImpl::waitTransfer(const uint32_t timeout_ms)
+{
+    if (!_queue_count) {
+        return m5::hal::error::error_t::OK;
+    }
+    spi_transaction_t* done{};
+    const esp_err_t err = spi_device_get_trans_result(_handle, &done, to_ticks(timeout_ms));
+    if (err != ESP_OK) {
+        return to_spi_error(err);
+    }
+
+    // Completed in the queued order
+    auto& q = _queue[_queue_head];
+    assert(done == &q.trans);
+    if (q.rx) {
+        for (size_t i = 0; i < q.trans.length / 8; ++i) {
+            q.rx[i] = q.trans.rx_data[i];
+        }
+    }
+    _queue_head = (_queue_head + 1) % MAX_QUEUE_DEPTH;
+    --_queue_count;
+    return m5::hal::error::error_t::OK;
+}
+
+m5::hal::error::error_t AdapterSPI::ESPIDFImpl::drain_queue()
+{
+    auto ret = m5::hal::error::error_t::OK;
+    while (_queue_count && ret == m5::hal::error::error_t::OK) {
+        ret = waitTransfer(UINT32_MAX);
     }
     return ret;
 }
 
-AdapterSPI::AdapterSPI(spi_device_handle_t handle, const gpio_num_t cs)
-    : Adapter(Adapter::Type::SPI, new AdapterSPI::ESPIDFImpl(handle, cs))
+AdapterSPI::AdapterSPI(spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs)
+    : Adapter(Adapter::Type::SPI, new AdapterSPI::ESPIDFImpl(handle, cs, hardware_cs))
 {
     assert(_impl);
 }
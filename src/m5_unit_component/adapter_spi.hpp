@@ -46,15 +46,54 @@ public:
             return _cs;
         }
 
-        virtual void beginTransaction()
+        //! @brief Allow nested beginTransaction by this device
+        inline void setNesting(const bool enable)
         {
+            _nesting = enable;
         }
-        virtual void endTransaction()
+        inline bool nesting() const
         {
+            return _nesting;
         }
 
+        virtual bool setDMA(const bool, const size_t)
+        {
+            return false;
+        }
+        virtual bool dmaEnabled() const
+        {
+            return false;
+        }
+
+        virtual bool setQueueDepth(const uint8_t)
+        {
+            return false;
+        }
+        virtual uint8_t queueDepth() const
+        {
+            return 0;
+        }
+        virtual m5::hal::error::error_t queueTransfer(const uint8_t*, uint8_t*, const size_t, const uint32_t)
+        {
+            return m5::hal::error::error_t::UNKNOWN_ERROR;
+        }
+        virtual m5::hal::error::error_t waitTransfer(const uint32_t)
+        {
+            return m5::hal::error::error_t::OK;
+        }
+        virtual size_t pendingTransfers() const
+        {
+            return 0;
+        }
+
+    protected:
+        // Write the register and data, in one transfer if small enough
+        m5::hal::error::error_t write_register(const uint8_t* reg, const size_t rlen, const uint8_t* data,
+                                               const size_t len);
+
     protected:
         gpio_num_t _cs{GPIO_NUM_NC};
+        bool _nesting{};
     };
 
 #if defined(ARDUINO)
@@ -74,18 +113,35 @@ public:
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx,
+                                                                const size_t len) override;
+        // Synchronous fallback (transferred on queueing)
+        virtual uint8_t queueDepth() const override
+        {
+            return 1;
+        }
+        virtual m5::hal::error::error_t queueTransfer(const uint8_t* tx, uint8_t* rx, const size_t len,
+                                                      const uint32_t timeout_ms) override;
+
+        struct host_state_t;
 
     protected:
         SPIClass* _spi{};
         SPISettings _settings{};
-        static uint32_t transaction_count;
+        host_state_t* _host{};  // Transaction state of the host (shared by the devices on the same SPIClass)
     };
 #endif
 
 #if defined(ESP_PLATFORM)
     class ESPIDFImpl : public SPIImpl {
     public:
-        ESPIDFImpl(spi_device_handle_t handle, const gpio_num_t cs);
+        ESPIDFImpl(spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs = false);
+        virtual ~ESPIDFImpl();
+        virtual bool setDMA(const bool enable, const size_t max_transfer) override;
+        virtual bool dmaEnabled() const override
+        {
+            return _dma;
+        }
         virtual void beginTransaction() override;
         virtual void endTransaction() override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
@@ -95,14 +151,46 @@ public:
                                                              const uint32_t stop) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
+        virtual m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx,
+                                                                const size_t len) override;
+
+        virtual bool setQueueDepth(const uint8_t depth) override;
+        virtual uint8_t queueDepth() const override
+        {
+            return _queue_depth;
+        }
+        virtual m5::hal::error::error_t queueTransfer(const uint8_t* tx, uint8_t* rx, const size_t len,
+                                                      const uint32_t timeout_ms) override;
+        virtual m5::hal::error::error_t waitTransfer(const uint32_t timeout_ms) override;
+        virtual size_t pendingTransfers() const override
+        {
+            return _queue_count;
+        }
+
+        static constexpr uint8_t MAX_QUEUE_DEPTH{8};  //!< Maximum number of in-flight transfers
 
     protected:
         m5::hal::error::error_t do_transmit(const uint8_t* tx, uint8_t* rx, const size_t len);
+        void release_dma_buffer();
+        m5::hal::error::error_t drain_queue();
+
+        struct queued_transfer_t {
+            spi_transaction_t trans{};
+            uint8_t* rx{};  // Destination of the inline rx_data
+        };
 
     private:
         spi_device_handle_t _handle{};
-        gpio_num_t _cs{GPIO_NUM_NC};
-        bool _in_transaction{false};
+        uint32_t _depth{};  // Transaction depth of this device (The driver arbitrates the host)
+        bool _dma{};
+        size_t _dma_size{};  // Maximum length of one transaction in DMA mode
+        uint8_t* _dma_tx{};  // Bounce buffers (DMA capable, aligned)
+        uint8_t* _dma_rx{};
+        queued_transfer_t _queue[MAX_QUEUE_DEPTH]{};  // Ring buffer of the in-flight transfers
+        uint8_t _queue_depth{1};
+        uint8_t _queue_head{};
+        uint8_t _queue_count{};
+        bool _hardware_cs{};  // CS is driven by the peripheral (spics_io_num of the device)
     };
 #endif
 
@@ -110,7 +198,13 @@ public:
     AdapterSPI(SPIClass& spi, const SPISettings& settings, const gpio_num_t cs);
 #endif
 #if defined(ESP_PLATFORM)
-    AdapterSPI(spi_device_handle_t handle, const gpio_num_t cs);
+    /*!
+      @param handle Device handle
+      @param cs CS pin
+      @param hardware_cs CS is driven by the peripheral if true (The device must be created with spics_io_num = cs).
+      Otherwise, CS is driven manually by gpio_set_level
+     */
+    AdapterSPI(spi_device_handle_t handle, const gpio_num_t cs, const bool hardware_cs = false);
 #endif
 
     inline SPIImpl* impl()
@@ -127,14 +221,98 @@ public:
         return impl()->cs_pin();
     }
 
-    inline virtual void beginTransaction() override
+    /*!
+      @brief Allow nested beginTransaction/endTransaction by this device
+      @param enable Allow if true
+      @details The inner begin/end only increase/decrease the depth, and the bus is released by the outermost
+      endTransaction. If not allowed (default), nesting is reported as an error
+      @note Transactions on the different hosts are independent in any case
+     */
+    inline void setNesting(const bool enable)
+    {
+        impl()->setNesting(enable);
+    }
+
+    ///@name DMA
+    ///@{
+    /*!
+      @brief Enable/Disable DMA transfer mode
+      @param enable Enable DMA mode if true
+      @param max_transfer Maximum length of one transaction (bus max_transfer_sz)
+      @return True if successful
+      @details In DMA mode, transfers are issued as single large transactions up to max_transfer.
+      DMA capable and aligned caller buffers are used directly, others via internal bounce buffers.
+      Transfers of 4 bytes or less always use the inline data of the transaction
+      @warning The bus must be initialized with a DMA channel (e.g. SPI_DMA_CH_AUTO)
+      @note Supported only by the ESP-IDF native driver
+     */
+    inline bool setDMA(const bool enable, const size_t max_transfer = 4096)
+    {
+        bus_lock_guard lock(impl()->busLock());
+        return impl()->setDMA(enable, max_transfer);
+    }
+    //! @brief Is DMA transfer mode enabled?
+    inline bool dmaEnabled() const
+    {
+        return impl()->dmaEnabled();
+    }
+    ///@}
+
+    ///@name Queued transfer
+    ///@{
+    /*!
+      @brief Set the maximum number of in-flight transfers
+      @param depth Depth (1 - ESPIDFImpl::MAX_QUEUE_DEPTH)
+      @return True if successful
+      @warning The device must be created with queue_size >= depth
+      @note Waits for the pending transfers
+     */
+    inline bool setQueueDepth(const uint8_t depth)
+    {
+        bus_lock_guard lock(impl()->busLock());
+        return impl()->setQueueDepth(depth);
+    }
+    //! @brief Gets the maximum number of in-flight transfers
+    inline uint8_t queueDepth() const
+    {
+        return impl()->queueDepth();
+    }
+    /*!
+      @brief Queue the transfer and return without waiting for completion
+      @param tx Data to send (nullptr: send dummy)
+      @param rx Destination (nullptr: discard)
+      @param len Length (up to the FIFO size, or the DMA max_transfer in DMA mode)
+      @param timeout_ms Time to wait for a free slot if the queue is full
+      @return OK if queued
+      @details The CPU can prepare the next command while the transfer is on the wire.
+      Completed transfers are retrieved by waitTransfer in the queued order
+      @warning tx and rx must remain valid until completed
+      @warning Use within beginTransaction/endTransaction to keep CS asserted.
+      endTransaction and the other read/write functions wait for the pending transfers
+      @note Transferred synchronously if the backend has no queue (SPIClass)
+     */
+    inline m5::hal::error::error_t queueTransfer(const uint8_t* tx, uint8_t* rx, const size_t len,
+                                                 const uint32_t timeout_ms = UINT32_MAX)
+    {
+        bus_lock_guard lock(impl()->busLock());
+        return impl()->queueTransfer(tx, rx, len, timeout_ms);
+    }
+    /*!
+      @brief Wait for the oldest pending transfer to complete
+      @param timeout_ms Timeout (0: poll)
+      @return OK if completed or nothing pending, TIMEOUT_ERROR if not yet completed
+     */
+    inline m5::hal::error::error_t waitTransfer(const uint32_t timeout_ms = UINT32_MAX)
     {
-        impl()->beginTransaction();
+        bus_lock_guard lock(impl()->busLock());
+        return impl()->waitTransfer(timeout_ms);
     }
-    inline virtual void endTransaction() override
+    //! @brief Gets the number of the pending transfers
+    inline size_t pendingTransfers() const
     {
-        impl()->endTransaction();
+        return impl()->pendingTransfers();
     }
+    ///@}
 
 protected:
     AdapterSPI() : Adapter(Adapter::Type::SPI, new SPIImpl())
@@ -19,35 +19,489 @@
 #include <M5HAL.hpp>
 #include <M5Utility.hpp>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 namespace m5 {
 namespace unit {
 
+namespace {
+constexpr uint32_t drain_stall_ms{1000};  // Give up draining if nothing is accepted for this long
+}  // namespace
+
+#if defined(ARDUINO)
+namespace {
+constexpr size_t discard_chunk_size{64};
+}  // namespace
+#endif
+
+#if defined(ESP_PLATFORM)
+namespace {
+constexpr size_t receiver_chunk_size{128};
+constexpr uint32_t receiver_stack_size{3072};
+constexpr UBaseType_t receiver_priority{5};
+constexpr uint32_t receiver_poll_ms{20};  // Interval to check the stop request
+constexpr int pattern_chr_tout{9};        // Baud cycles (only one character is detected)
+constexpr int pattern_queue_size{32};     // Number of the pattern positions recorded
+constexpr uint32_t stream_stack_size{3072};
+constexpr UBaseType_t stream_priority{6};  // Above the receiver, the driver ring buffer is small
+constexpr uint32_t stream_idle_ms{5};      // Hand over a partial buffer after this idle time (at least 1 tick)
+}  // namespace
+#endif
+
+bool AdapterUART::UARTImpl::readFrame(UARTFramer& framer, uart::frame_t& frame)
+{
+    if (framer.next(frame)) {
+        return true;
+    }
+    for (;;) {
+        size_t cap{};
+        auto p         = framer.prepare(cap);
+        const size_t n = readAvailable(p, cap);
+        framer.commit(n);
+        if (framer.next(frame)) {
+            return true;
+        }
+        if (!n) {
+            return false;
+        }
+    }
+}
+
+// Asynchronous TX
+bool AdapterUART::UARTImpl::beginAsyncTX(const size_t buffer_size)
+{
+    if (asyncTX()) {
+        return true;
+    }
+    if (!buffer_size) {
+        return false;
+    }
+    _tx_buf.assign(buffer_size, 0);
+    _tx_head = _tx_count = 0;
+    _tx_cb_head = _tx_cb_count = 0;
+    return true;
+}
+
+bool AdapterUART::UARTImpl::endAsyncTX()
+{
+    if (!asyncTX()) {
+        return true;
+    }
+    const bool drained = drain_tx();
+    if (!drained) {
+        // Not sent, so the tickets stay incomplete and the callbacks are not called
+        M5_LIB_LOGE("Discard %zu bytes and %u callbacks", _tx_count, _tx_cb_count);
+    }
+    for (auto&& cb : _tx_callbacks) {
+        cb.func = nullptr;
+    }
+    _tx_head = _tx_count = 0;
+    _tx_cb_head = _tx_cb_count = 0;
+    _tx_buf.clear();
+    _tx_buf.shrink_to_fit();
+    return drained;
+}
+
+bool AdapterUART::UARTImpl::writeAsync(const uint8_t* data, const size_t len, uint32_t* ticket,
+                                       std::function<void()> on_done)
+{
+    if (!asyncTX() || !data || !len) {
+        return false;
+    }
+    pollTX();  // Make room first
+    if (len > txFree() || (on_done && _tx_cb_count >= MAX_TX_CALLBACKS)) {
+        return false;
+    }
+
+    size_t tail = (_tx_head + _tx_count) % _tx_buf.size();
+    size_t n    = std::min(len, _tx_buf.size() - tail);
+    std::memcpy(_tx_buf.data() + tail, data, n);
+    std::memcpy(_tx_buf.data(), data + n, len - n);
+    _tx_count += len;
+    _tx_queued += len;
+
+    if (ticket) {
+        *ticket = _tx_queued;
+    }
+    if (on_done) {
+        auto& cb = _tx_callbacks[(_tx_cb_head + _tx_cb_count++) % MAX_TX_CALLBACKS];
+        cb.end   = _tx_queued;
+        cb.func  = on_done;
+    }
+    pollTX();
+    return true;
+}
+
+size_t AdapterUART::UARTImpl::pollTX()
+{
+    size_t total{};
+    while (_tx_count) {
+        // Contiguous part from the head
+        const size_t n    = std::min(_tx_count, _tx_buf.size() - _tx_head);
+        const size_t sent = write_available(_tx_buf.data() + _tx_head, n);
+        if (!sent) {
+            break;
+        }
+        _tx_head = (_tx_head + sent) % _tx_buf.size();
+        _tx_count -= sent;
+        _tx_sent += sent;
+        total += sent;
+        if (sent < n) {
+            break;
+        }
+    }
+    while (_tx_cb_count && txDone(_tx_callbacks[_tx_cb_head].end)) {
+        auto func = std::move(_tx_callbacks[_tx_cb_head].func);
+        _tx_callbacks[_tx_cb_head].func = nullptr;
+        _tx_cb_head                     = (_tx_cb_head + 1) % MAX_TX_CALLBACKS;
+        --_tx_cb_count;
+        func();
+    }
+    return total;
+}
+
+bool AdapterUART::UARTImpl::drain_tx()
+{
+    auto last = m5::utility::millis();
+    while (_tx_count) {
+        if (pollTX()) {
+            last = m5::utility::millis();
+            continue;
+        }
+        if (m5::utility::millis() - last > drain_stall_ms) {
+            // Kept in the queue, the caller must not write behind it
+            M5_LIB_LOGE("TX stalled, %zu bytes remain", _tx_count);
+            return false;
+        }
+        m5::utility::delay(1);
+    }
+    return true;
+}
+
+#if defined(ESP_PLATFORM)
+
+// Event-driven RX
+bool AdapterUART::UARTImpl::beginEventRX(const size_t buffer_size)
+{
+    if (_rx_stream) {
+        return true;
+    }
+    if (!buffer_size) {
+        return false;
+    }
+    _rx_stream = xStreamBufferCreate(buffer_size, 1);
+    if (!_rx_stream) {
+        M5_LIB_LOGE("Failed to create RX buffer %zu", buffer_size);
+        return false;
+    }
+    _rx_ready   = false;
+    _rx_dropped = 0;
+    if (!start_receiver()) {
+        M5_LIB_LOGE("Failed to start receiver");
+        vStreamBufferDelete(_rx_stream);
+        _rx_stream = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void AdapterUART::UARTImpl::endEventRX()
+{
+    if (_rx_stream) {
+        stop_receiver();
+        vStreamBufferDelete(_rx_stream);
+        _rx_stream = nullptr;
+        _rx_ready  = false;
+    }
+}
+
+void AdapterUART::UARTImpl::push_rx(const uint8_t* data, const size_t len)
+{
+    const size_t sent = xStreamBufferSend(_rx_stream, data, len, 0);
+    if (sent < len) {
+        _rx_dropped.fetch_add(len - sent, std::memory_order_relaxed);
+    }
+    if (sent) {
+        _rx_ready.store(true, std::memory_order_release);
+        if (_rx_callback) {
+            _rx_callback();
+        }
+    }
+}
+
+m5::hal::error::error_t AdapterUART::UARTImpl::read_rx(uint8_t* data, const size_t len, const uint32_t timeout_ms)
+{
+    if (!data) {
+        return m5::hal::error::error_t::INVALID_ARGUMENT;
+    }
+    const TickType_t limit = pdMS_TO_TICKS(timeout_ms);
+    const TickType_t start = xTaskGetTickCount();
+    TickType_t remain      = limit;
+    size_t got{};
+    for (;;) {
+        got += xStreamBufferReceive(_rx_stream, data + got, len - got, remain);
+        const TickType_t elapsed = xTaskGetTickCount() - start;
+        if (got >= len || elapsed >= limit) {
+            break;
+        }
+        remain = limit - elapsed;
+    }
+    // Clear first so that data pushed meanwhile is not missed
+    _rx_ready.store(false, std::memory_order_release);
+    if (xStreamBufferBytesAvailable(_rx_stream)) {
+        _rx_ready.store(true, std::memory_order_release);
+    }
+    return (got == len) ? m5::hal::error::error_t::OK : m5::hal::error::error_t::TIMEOUT_ERROR;
+}
+
+size_t AdapterUART::UARTImpl::read_rx_available(uint8_t* data, const size_t len)
+{
+    const size_t got = xStreamBufferReceive(_rx_stream, data, len, 0);
+    _rx_ready.store(false, std::memory_order_release);
+    if (xStreamBufferBytesAvailable(_rx_stream)) {
+        _rx_ready.store(true, std::memory_order_release);
+    }
+    return got;
+}
+
+// Streaming RX
+bool AdapterUART::UARTImpl::beginStreamRX(const size_t buffer_size, const uint8_t buffers)
+{
+    if (streamRX()) {
+        return true;
+    }
+    if (eventRX() || !buffer_size || buffers < 2 || buffers > MAX_STREAM_BUFFERS) {
+        return false;
+    }
+    if (read_stream(nullptr, 0, 0) < 0) {
+        M5_LIB_LOGE("Not supported");
+        return false;
+    }
+
+    _stream_buf.assign(buffer_size * buffers, 0);
+    _stream_size = buffer_size;
+    _stream_free = xQueueCreate(buffers, sizeof(uint8_t));
+    _stream_full = xQueueCreate(buffers, sizeof(uint8_t));
+    if (!_stream_free || !_stream_full) {
+        M5_LIB_LOGE("Failed to create queues");
+        endStreamRX();
+        return false;
+    }
+    for (uint8_t i = 0; i < buffers; ++i) {
+        xQueueSend(_stream_free, &i, 0);
+    }
+    _stream_overruns = 0;
+    _stream_lent     = 0;
+    _stream_stop     = false;
+    _stream_running  = true;
+    if (xTaskCreatePinnedToCore(stream_task, "M5UnitUartStream", stream_stack_size, this, stream_priority,
+                                &_stream_task, tskNO_AFFINITY) != pdPASS) {
+        M5_LIB_LOGE("Failed to create task");
+        _stream_running = false;
+        endStreamRX();
+        return false;
+    }
+    return true;
+}
+
+void AdapterUART::UARTImpl::endStreamRX()
+{
+    if (_stream_task) {
+        _stream_stop = true;
+        while (_stream_running) {
+            vTaskDelay(1);
+        }
+        _stream_task = nullptr;
+    }
+    if (_stream_free) {
+        vQueueDelete(_stream_free);
+        _stream_free = nullptr;
+    }
+    if (_stream_full) {
+        vQueueDelete(_stream_full);
+        _stream_full = nullptr;
+    }
+    _stream_buf.clear();
+    _stream_buf.shrink_to_fit();
+}
+
+const uint8_t* AdapterUART::UARTImpl::acquireStream(size_t& len, const uint32_t timeout_ms)
+{
+    len = 0;
+    uint8_t idx{};
+    if (!streamRX() || xQueueReceive(_stream_full, &idx, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return nullptr;
+    }
+    _stream_lent.fetch_or(1U << idx, std::memory_order_relaxed);
+    len = _stream_len[idx];
+    return _stream_buf.data() + idx * _stream_size;
+}
+
+void AdapterUART::UARTImpl::releaseStream(const uint8_t* buf)
+{
+    if (!streamRX() || buf < _stream_buf.data()) {
+        return;
+    }
+    const size_t offset = buf - _stream_buf.data();
+    if (offset < _stream_buf.size() && offset % _stream_size == 0) {
+        const uint8_t idx = offset / _stream_size;
+        const uint8_t bit = 1U << idx;
+        // Ignore the buffer not lent (e.g. released twice), it may be held by the consumer
+        if (_stream_lent.fetch_and(~bit, std::memory_order_relaxed) & bit) {
+            xQueueSend(_stream_free, &idx, 0);
+        }
+    }
+}
+
+void AdapterUART::UARTImpl::stream_task(void* arg)
+{
+    auto self = static_cast<AdapterUART::UARTImpl*>(arg);
+    int cur{-1};
+    size_t filled{};
+    while (!self->_stream_stop) {
+        if (cur < 0) {
+            uint8_t idx{};
+            if (xQueueReceive(self->_stream_free, &idx, 1) != pdTRUE) {
+                // All buffers are in use, keep the driver buffer from overflowing
+                self->_stream_overruns.fetch_add(self->discard_stream(), std::memory_order_relaxed);
+                continue;
+            }
+            cur    = idx;
+            filled = 0;
+        }
+        // Read straight into the buffer to be handed over, the only copy is out of the driver ring buffer
+        uint8_t* buf  = self->_stream_buf.data() + cur * self->_stream_size;
+        const int got = self->read_stream(buf + filled, self->_stream_size - filled, stream_idle_ms);
+        if (got > 0) {
+            filled += got;
+        }
+        if (filled == self->_stream_size || (got <= 0 && filled)) {
+            self->_stream_len[cur] = filled;
+            const uint8_t idx      = cur;
+            xQueueSend(self->_stream_full, &idx, 0);  // Never full, the number of the buffers is the same
+            cur = -1;
+        }
+    }
+    self->_stream_running = false;
+    vTaskDelete(nullptr);
+}
+
+void AdapterUART::UARTImpl::flush_rx_stream()
+{
+    if (_rx_stream) {
+        xStreamBufferReset(_rx_stream);
+        _rx_ready = false;
+    }
+}
+#endif
+
 #if defined(ARDUINO)
 
 AdapterUART::SerialImpl::SerialImpl(HardwareSerial& serial) : AdapterUART::UARTImpl(), _serial(&serial)
 {
 }
 
+AdapterUART::SerialImpl::~SerialImpl()
+{
+#if defined(ESP_PLATFORM)
+    endEventRX();
+#endif
+}
+
+#if defined(ESP_PLATFORM)
+bool AdapterUART::SerialImpl::start_receiver()
+{
+    _rx_stopping = false;
+    _serial->onReceive([this]() {
+        // Counted before checking the stop request, so that stop_receiver can wait for this
+        ++_rx_in_callback;
+        if (!_rx_stopping) {
+            uint8_t buf[receiver_chunk_size];
+            int avail{};
+            while ((avail = _serial->available()) > 0) {
+                const size_t n = _serial->read(buf, std::min<size_t>(avail, sizeof(buf)));
+                if (!n) {
+                    break;
+                }
+                push_rx(buf, n);
+            }
+        }
+        --_rx_in_callback;
+    });
+    return true;
+}
+
+void AdapterUART::SerialImpl::stop_receiver()
+{
+    _rx_stopping = true;
+    _serial->onReceive(nullptr);
+    // The callback may be running on the UART event task, wait before the buffer is deleted
+    while (_rx_in_callback) {
+        vTaskDelay(1);
+    }
+}
+#endif
+
 void AdapterUART::SerialImpl::flush()
 {
+    drain_tx();
     _serial->flush();
 }
 
 void AdapterUART::SerialImpl::flushRX()
 {
-    while (_serial->available()) {
-        (void)_serial->read();  // Discard
+    // Discard in chunks
+    uint8_t buf[discard_chunk_size];
+    int avail{};
+    while ((avail = _serial->available()) > 0) {
+        if (!_serial->read(buf, std::min<size_t>(avail, sizeof(buf)))) {
+            break;
+        }
     }
+#if defined(ESP_PLATFORM)
+    flush_rx_stream();
+#endif
 }
 
 void AdapterUART::SerialImpl::setTimeout(const uint32_t ms)
 {
+    _timeout_ms = ms;
     _serial->setTimeout(ms);
 }
 
+size_t AdapterUART::SerialImpl::available()
+{
+#if defined(ESP_PLATFORM)
+    if (eventRX()) {
+        return xStreamBufferBytesAvailable(_rx_stream);
+    }
+#endif
+    const int avail = _serial->available();
+    return (avail > 0) ? static_cast<size_t>(avail) : 0;
+}
+
+size_t AdapterUART::SerialImpl::readAvailable(uint8_t* data, const size_t len)
+{
+    if (!data || !len) {
+        return 0;
+    }
+#if defined(ESP_PLATFORM)
+    if (eventRX()) {
+        return read_rx_available(data, len);
+    }
+#endif
+    const int avail = _serial->available();
+    return (avail > 0) ? _serial->read(data, std::min<size_t>(avail, len)) : 0;
+}
+
 m5::hal::error::error_t AdapterUART::SerialImpl::readWithTransaction(uint8_t* data, const size_t len)
 {
+#if defined(ESP_PLATFORM)
+    if (eventRX()) {
+        return read_rx(data, len, _timeout_ms);
+    }
+#endif
     return (_serial->readBytes(data, len) == len) ? m5::hal::error::error_t::OK
                                                   : m5::hal::error::error_t::TIMEOUT_ERROR;
 }
@@ -55,9 +509,18 @@ m5::hal::error::error_t AdapterUART::SerialImpl::readWithTransaction(uint8_t* da
 m5::hal::error::error_t AdapterUART::SerialImpl::writeWithTransaction(const uint8_t* data, const size_t len,
                                                                       const uint32_t /* unused */)
 {
+    if (!drain_tx()) {
+        return m5::hal::error::error_t::TIMEOUT_ERROR;
+    }
     return (_serial->write(data, len) == len) ? m5::hal::error::error_t::OK : m5::hal::error::error_t::TIMEOUT_ERROR;
 }
 
+size_t AdapterUART::SerialImpl::write_available(const uint8_t* data, const size_t len)
+{
+    const int room = _serial->availableForWrite();
+    return (room > 0) ? _serial->write(data, std::min<size_t>(room, len)) : 0;
+}
+
 AdapterUART::AdapterUART(HardwareSerial& serial) : Adapter(Adapter::Type::UART, new AdapterUART::SerialImpl(serial))
 {
     assert(_impl);
@@ -66,11 +529,87 @@ AdapterUART::AdapterUART(HardwareSerial& serial) : Adapter(Adapter::Type::UART,
 
 #if defined(ESP_PLATFORM)
 
+AdapterUART::ESPIDFImpl::~ESPIDFImpl()
+{
+    endStreamRX();
+    endEventRX();
+    if (_pattern_chr >= 0 && uart_is_driver_installed(_uart_num)) {
+        uart_disable_pattern_det_intr(_uart_num);
+    }
+}
+
+int AdapterUART::ESPIDFImpl::read_stream(uint8_t* data, const size_t len, const uint32_t timeout_ms)
+{
+    if (!uart_is_driver_installed(_uart_num)) {
+        return -1;
+    }
+    // At least 1 tick, 0 tick (e.g. 5 ms at 100 Hz tick) returns at once and the stream task spins while idle
+    const TickType_t ticks = std::max<TickType_t>(pdMS_TO_TICKS(timeout_ms), 1);
+    return len ? uart_read_bytes(_uart_num, data, len, ticks) : 0;
+}
+
+size_t AdapterUART::ESPIDFImpl::discard_stream()
+{
+    size_t buffered{};
+    if (uart_get_buffered_data_len(_uart_num, &buffered) == ESP_OK && buffered) {
+        uart_flush_input(_uart_num);
+    }
+    return buffered;
+}
+
+bool AdapterUART::ESPIDFImpl::start_receiver()
+{
+    if (!uart_is_driver_installed(_uart_num) || streamRX()) {
+        return false;
+    }
+    _rx_stop    = false;
+    _rx_running = true;
+    if (xTaskCreatePinnedToCore(receiver_task, "M5UnitUartRX", receiver_stack_size, this, receiver_priority, &_rx_task,
+                                tskNO_AFFINITY) != pdPASS) {
+        _rx_running = false;
+        return false;
+    }
+    return true;
+}
+
+void AdapterUART::ESPIDFImpl::stop_receiver()
+{
+    _rx_stop = true;
+    while (_rx_running) {
+        vTaskDelay(1);
+    }
+    _rx_task = nullptr;
+}
+
+void AdapterUART::ESPIDFImpl::receiver_task(void* arg)
+{
+    auto self = static_cast<AdapterUART::ESPIDFImpl*>(arg);
+    uint8_t buf[receiver_chunk_size];
+    while (!self->_rx_stop) {
+        // Wait for the first byte, then take what is already buffered
+        int got = uart_read_bytes(self->_uart_num, buf, 1, pdMS_TO_TICKS(receiver_poll_ms));
+        if (got <= 0) {
+            continue;
+        }
+        size_t buffered{};
+        if (uart_get_buffered_data_len(self->_uart_num, &buffered) == ESP_OK && buffered) {
+            const int n = uart_read_bytes(self->_uart_num, buf + 1, std::min(buffered, sizeof(buf) - 1), 0);
+            if (n > 0) {
+                got += n;
+            }
+        }
+        self->push_rx(buf, static_cast<size_t>(got));
+    }
+    self->_rx_running = false;
+    vTaskDelete(nullptr);
+}
+
 void AdapterUART::ESPIDFImpl::flush()
 {
     if (!uart_is_driver_installed(_uart_num)) {
         return;
     }
+    drain_tx();
     uart_wait_tx_done(_uart_num, pdMS_TO_TICKS(_timeout_ms));
 }
 
@@ -80,6 +619,7 @@ void AdapterUART::ESPIDFImpl::flushRX()
         return;
     }
     uart_flush_input(_uart_num);
+    flush_rx_stream();
 }
 
 void AdapterUART::ESPIDFImpl::setTimeout(const uint32_t ms)
@@ -87,8 +627,119 @@ void AdapterUART::ESPIDFImpl::setTimeout(const uint32_t ms)
     _timeout_ms = ms;
 }
 
+size_t AdapterUART::ESPIDFImpl::available()
+{
+    if (eventRX()) {
+        return xStreamBufferBytesAvailable(_rx_stream);
+    }
+    size_t buffered{};
+    if (!uart_is_driver_installed(_uart_num) || uart_get_buffered_data_len(_uart_num, &buffered) != ESP_OK) {
+        return 0;
+    }
+    return buffered;
+}
+
+size_t AdapterUART::ESPIDFImpl::readAvailable(uint8_t* data, const size_t len)
+{
+    if (!data || !len) {
+        return 0;
+    }
+    if (eventRX()) {
+        return read_rx_available(data, len);
+    }
+    size_t buffered{};
+    if (!uart_is_driver_installed(_uart_num) || uart_get_buffered_data_len(_uart_num, &buffered) != ESP_OK ||
+        !buffered) {
+        return 0;
+    }
+    const int got = uart_read_bytes(_uart_num, data, std::min(buffered, len), 0);
+    return (got > 0) ? static_cast<size_t>(got) : 0;
+}
+
+bool AdapterUART::ESPIDFImpl::enable_pattern(const uint8_t chr)
+{
+    if (_pattern_chr == chr) {
+        return true;
+    }
+    if (uart_enable_pattern_det_baud_intr(_uart_num, static_cast<char>(chr), 1, pattern_chr_tout, 0, 0) != ESP_OK ||
+        uart_pattern_queue_reset(_uart_num, pattern_queue_size) != ESP_OK) {
+        M5_LIB_LOGW("Failed to enable pattern detection");
+        return false;
+    }
+    _pattern_chr  = chr;
+    _pattern_run  = 0;
+    _pattern_lost = false;
+    return true;
+}
+
+bool AdapterUART::ESPIDFImpl::readFrame(UARTFramer& framer, uart::frame_t& frame)
+{
+    const auto& cfg = framer.config();
+    if (eventRX() || cfg.mode != uart::FrameMode::Delimiter || cfg.delimiter_len != 1 ||
+        !uart_is_driver_installed(_uart_num)) {
+        return UARTImpl::readFrame(framer, frame);
+    }
+    if (framer.next(frame)) {
+        return true;
+    }
+    if (_pattern_chr != cfg.delimiter[0]) {
+        if (!enable_pattern(cfg.delimiter[0])) {
+            return UARTImpl::readFrame(framer, frame);
+        }
+        // Delimiters received before enabling have no recorded position
+        if (UARTImpl::readFrame(framer, frame)) {
+            return true;
+        }
+    }
+
+    // Positions lost by the overflow of the queue, scan until the buffered data is consumed
+    if (_pattern_lost) {
+        const bool ret = UARTImpl::readFrame(framer, frame);
+        size_t buffered{};
+        _pattern_lost = (uart_get_buffered_data_len(_uart_num, &buffered) != ESP_OK || buffered);
+        if (ret) {
+            return true;
+        }
+    }
+
+    int pos{};
+    while ((pos = uart_pattern_pop_pos(_uart_num)) >= 0) {
+        ++_pattern_run;
+        // Read just up to the delimiter
+        size_t want = static_cast<size_t>(pos) + 1;
+        while (want) {
+            size_t cap{};
+            auto p  = framer.prepare(cap);
+            int got = uart_read_bytes(_uart_num, p, std::min(want, cap), 0);
+            if (got <= 0) {
+                break;
+            }
+            framer.commit(got);
+            want -= got;
+        }
+        if (framer.next(frame)) {
+            return true;
+        }
+    }
+
+    // The queue holds (pattern_queue_size - 1) positions. If it was full since it was last empty,
+    // further positions may have been dropped, so scan what is buffered
+    // (uart_read_bytes keeps the remaining positions consistent)
+    const bool full = (_pattern_run >= pattern_queue_size - 1);
+    _pattern_run    = 0;
+    if (full) {
+        M5_LIB_LOGD("Pattern queue may have overflowed");
+        _pattern_lost = true;
+        return readFrame(framer, frame);
+    }
+    return false;
+}
+
 m5::hal::error::error_t AdapterUART::ESPIDFImpl::readWithTransaction(uint8_t* data, const size_t len)
 {
+    if (eventRX()) {
+        return read_rx(data, len, _timeout_ms);
+    }
     if (!uart_is_driver_installed(_uart_num) || data == nullptr) {
         return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
@@ -105,6 +756,9 @@ m5::hal::error::error_t AdapterUART::ESPIDFImpl::writeWithTransaction(const uint
     if (!uart_is_driver_installed(_uart_num) || data == nullptr) {
         return m5::hal::error::error_t::UNKNOWN_ERROR;
     }
+    if (!drain_tx()) {
+        return m5::hal::error::error_t::TIMEOUT_ERROR;
+    }
     int written = uart_write_bytes(_uart_num, reinterpret_cast<const char*>(data), len);
     if (written < 0 || static_cast<size_t>(written) != len) {
         return m5::hal::error::error_t::TIMEOUT_ERROR;
@@ -112,6 +766,17 @@ m5::hal::error::error_t AdapterUART::ESPIDFImpl::writeWithTransaction(const uint
     return m5::hal::error::error_t::OK;
 }
 
+size_t AdapterUART::ESPIDFImpl::write_available(const uint8_t* data, const size_t len)
+{
+    if (!uart_is_driver_installed(_uart_num)) {
+        return 0;
+    }
+    // Fills the TX FIFO directly, bypassing the TX ring buffer of the driver
+    // If the driver has the TX ring buffer, bytes of uart_write_bytes still in it are sent after these
+    const int sent = uart_tx_chars(_uart_num, reinterpret_cast<const char*>(data), len);
+    return (sent > 0) ? static_cast<size_t>(sent) : 0;
+}
+
 AdapterUART::AdapterUART(const uart_port_t uart_num)
     : Adapter(Adapter::Type::UART, new AdapterUART::ESPIDFImpl(uart_num))
 {
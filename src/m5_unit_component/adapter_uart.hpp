@@ -12,8 +12,16 @@
 #define M5_UNIT_COMPONENT_ADAPTER_UART_HPP
 
 #include "adapter_base.hpp"
+#include "uart_framer.hpp"
+#include <functional>
+#include <vector>
 #if defined(ESP_PLATFORM)
+#include <atomic>
 #include <driver/uart.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/task.h>
 #endif
 
 class HardwareSerial;
@@ -44,6 +52,137 @@ public:
         virtual void setTimeout(const uint32_t)
         {
         }
+        // Number of bytes received and not yet read
+        virtual size_t available()
+        {
+            return 0;
+        }
+        // Read what is already received without waiting
+        virtual size_t readAvailable(uint8_t*, const size_t)
+        {
+            return 0;
+        }
+        virtual bool readFrame(UARTFramer& framer, uart::frame_t& frame);
+
+        // Asynchronous TX
+        bool beginAsyncTX(const size_t buffer_size);
+        bool endAsyncTX();
+        inline bool asyncTX() const
+        {
+            return !_tx_buf.empty();
+        }
+        bool writeAsync(const uint8_t* data, const size_t len, uint32_t* ticket, std::function<void()> on_done);
+        size_t pollTX();
+        inline bool txDone(const uint32_t ticket) const
+        {
+            return static_cast<int32_t>(_tx_sent - ticket) >= 0;
+        }
+        inline size_t txPending() const
+        {
+            return _tx_count;
+        }
+        inline size_t txFree() const
+        {
+            return _tx_buf.size() - _tx_count;
+        }
+
+#if defined(ESP_PLATFORM)
+        // Event-driven RX
+        bool beginEventRX(const size_t buffer_size);
+        void endEventRX();
+        inline bool eventRX() const
+        {
+            return _rx_stream != nullptr;
+        }
+        inline bool rxReady() const
+        {
+            return _rx_ready.load(std::memory_order_acquire);
+        }
+        inline uint32_t rxDropped() const
+        {
+            return _rx_dropped.load(std::memory_order_relaxed);
+        }
+        inline void setRXCallback(std::function<void()> cb)
+        {
+            _rx_callback = cb;
+        }
+
+        // Streaming RX
+        static constexpr uint8_t MAX_STREAM_BUFFERS{4};
+        bool beginStreamRX(const size_t buffer_size, const uint8_t buffers);
+        void endStreamRX();
+        inline bool streamRX() const
+        {
+            return _stream_task != nullptr;
+        }
+        const uint8_t* acquireStream(size_t& len, const uint32_t timeout_ms);
+        void releaseStream(const uint8_t* buf);
+        inline uint32_t streamOverruns() const
+        {
+            return _stream_overruns.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        // Backend specific block read for streaming (-1: not supported)
+        virtual int read_stream(uint8_t*, const size_t, const uint32_t)
+        {
+            return -1;
+        }
+        // Discard the data received while no buffer is free
+        virtual size_t discard_stream()
+        {
+            return 0;
+        }
+        static void stream_task(void* arg);
+        // Backend specific receiver that calls push_rx
+        virtual bool start_receiver()
+        {
+            return false;
+        }
+        virtual void stop_receiver()
+        {
+        }
+        void push_rx(const uint8_t* data, const size_t len);
+        m5::hal::error::error_t read_rx(uint8_t* data, const size_t len, const uint32_t timeout_ms);
+        size_t read_rx_available(uint8_t* data, const size_t len);
+        void flush_rx_stream();
+
+        StreamBufferHandle_t _rx_stream{};
+        std::function<void()> _rx_callback{};
+        std::atomic<bool> _rx_ready{};
+        std::atomic<uint32_t> _rx_dropped{};
+
+        std::vector<uint8_t> _stream_buf{};
+        size_t _stream_size{};
+        size_t _stream_len[MAX_STREAM_BUFFERS]{};
+        QueueHandle_t _stream_free{};  // Indexes of the buffers to fill
+        QueueHandle_t _stream_full{};  // Indexes of the filled buffers
+        TaskHandle_t _stream_task{};
+        std::atomic<bool> _stream_stop{};
+        std::atomic<bool> _stream_running{};
+        std::atomic<uint32_t> _stream_overruns{};
+        std::atomic<uint8_t> _stream_lent{};  // Bits of the buffers lent by acquireStream
+#endif
+
+    protected:
+        // Write as many bytes as the backend accepts without blocking
+        virtual size_t write_available(const uint8_t*, const size_t)
+        {
+            return 0;
+        }
+        // Send all queued bytes before the synchronous write, false if stalled (the bytes are kept)
+        bool drain_tx();
+
+        static constexpr uint8_t MAX_TX_CALLBACKS{8};
+        struct tx_callback_t {
+            uint32_t end{};  // Completed when _tx_sent reaches here
+            std::function<void()> func{};
+        };
+        std::vector<uint8_t> _tx_buf{};
+        size_t _tx_head{}, _tx_count{};
+        uint32_t _tx_queued{}, _tx_sent{};  // Total bytes (wrap around)
+        tx_callback_t _tx_callbacks[MAX_TX_CALLBACKS]{};
+        uint8_t _tx_cb_head{}, _tx_cb_count{};
     };
 
     //
@@ -51,6 +190,7 @@ public:
     class SerialImpl : public UARTImpl {
     public:
         explicit SerialImpl(HardwareSerial& serial);
+        virtual ~SerialImpl();
         inline virtual HardwareSerial* getSerial() override
         {
             return _serial;
@@ -58,12 +198,26 @@ public:
         virtual void flush() override;
         virtual void flushRX() override;
         virtual void setTimeout(const uint32_t ms) override;
+        virtual size_t available() override;
+        virtual size_t readAvailable(uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
 
+    protected:
+        virtual size_t write_available(const uint8_t* data, const size_t len) override;
+#if defined(ESP_PLATFORM)
+        virtual bool start_receiver() override;
+        virtual void stop_receiver() override;
+#endif
+
     protected:
         HardwareSerial* _serial{};
+        uint32_t _timeout_ms{1000};
+#if defined(ESP_PLATFORM)
+        std::atomic<bool> _rx_stopping{};
+        std::atomic<uint8_t> _rx_in_callback{};  // Receive callbacks running
+#endif
     };
 #endif
 
@@ -73,9 +227,13 @@ public:
         explicit ESPIDFImpl(const uart_port_t uart_num) : AdapterUART::UARTImpl(), _uart_num(uart_num)
         {
         }
+        virtual ~ESPIDFImpl();
         virtual void flush() override;
         virtual void flushRX() override;
         virtual void setTimeout(const uint32_t ms) override;
+        virtual size_t available() override;
+        virtual size_t readAvailable(uint8_t* data, const size_t len) override;
+        virtual bool readFrame(UARTFramer& framer, uart::frame_t& frame) override;
         virtual m5::hal::error::error_t readWithTransaction(uint8_t* data, const size_t len) override;
         virtual m5::hal::error::error_t writeWithTransaction(const uint8_t* data, const size_t len,
                                                              const uint32_t stop) override;
@@ -84,9 +242,24 @@ public:
             return _uart_num;
         }
 
+    protected:
+        virtual size_t write_available(const uint8_t* data, const size_t len) override;
+        virtual int read_stream(uint8_t* data, const size_t len, const uint32_t timeout_ms) override;
+        virtual size_t discard_stream() override;
+        virtual bool start_receiver() override;
+        virtual void stop_receiver() override;
+        static void receiver_task(void* arg);
+        bool enable_pattern(const uint8_t chr);
+
     protected:
         uart_port_t _uart_num{UART_NUM_1};
         uint32_t _timeout_ms{1000};
+        int16_t _pattern_chr{-1};  // Delimiter detected by hardware (-1: disabled)
+        uint16_t _pattern_run{};   // Positions popped since the queue was last empty
+        bool _pattern_lost{};      // The queue may have overflowed (positions are lost)
+        TaskHandle_t _rx_task{};
+        std::atomic<bool> _rx_stop{};
+        std::atomic<bool> _rx_running{};
     };
 #endif
 
@@ -102,6 +275,7 @@ public:
     {
         impl()->flush();
     }
+    //! @brief Discard all received data
     inline void flushRX()
     {
         impl()->flushRX();
@@ -111,6 +285,210 @@ public:
         impl()->setTimeout(ms);
     }
 
+    ///@name Asynchronous TX
+    ///@{
+    /*!
+      @brief Begin asynchronous TX
+      @param buffer_size Size of the transmit queue
+      @return True if successful
+      @details writeAsync queues the data and returns at once. Queued data is handed to the UART
+      as far as it accepts without blocking, on writeAsync and on each pollTX
+      @note Synchronous writes and flush send the queued data first to keep the order.
+      If the UART does not accept it for a while, the synchronous write fails with TIMEOUT_ERROR
+      @warning Nothing sends the queued data in the background, the progress depends on pollTX being called
+      @warning ESP-IDF: The data is written to the TX FIFO by uart_tx_chars, which bypasses the TX ring buffer
+      of the driver. Install the driver without the TX ring buffer to keep the order with the synchronous writes
+     */
+    inline bool beginAsyncTX(const size_t buffer_size = 1024)
+    {
+        return impl()->beginAsyncTX(buffer_size);
+    }
+    /*!
+      @brief End asynchronous TX (Queued data is sent before)
+      @return True if all the queued data was sent. False if stalled and discarded
+      (the tickets stay incomplete and the callbacks are not called)
+     */
+    inline bool endAsyncTX()
+    {
+        return impl()->endAsyncTX();
+    }
+    //! @brief Is asynchronous TX running?
+    inline bool asyncTX() const
+    {
+        return impl()->asyncTX();
+    }
+    /*!
+      @brief Queue the data to send
+      @param data Data to send
+      @param len Length of the data
+      @param[out] ticket Ticket for txDone if not nullptr
+      @param on_done Called (from pollTX/writeAsync) when all the data has been handed to the UART
+      @return True if queued. False if the queue does not have enough space (back-pressure)
+     */
+    inline bool writeAsync(const uint8_t* data, const size_t len, uint32_t* ticket = nullptr,
+                           std::function<void()> on_done = nullptr)
+    {
+        return impl()->writeAsync(data, len, ticket, on_done);
+    }
+    /*!
+      @brief Hand the queued data to the UART without blocking
+      @return Number of bytes handed
+      @note Call periodically (e.g. every loop) while asynchronous TX is running
+     */
+    inline size_t pollTX()
+    {
+        return impl()->pollTX();
+    }
+    //! @brief Has the data of the ticket been handed to the UART?
+    inline bool txDone(const uint32_t ticket) const
+    {
+        return impl()->txDone(ticket);
+    }
+    //! @brief Gets the number of queued bytes
+    inline size_t txPending() const
+    {
+        return impl()->txPending();
+    }
+    //! @brief Gets the free space of the queue
+    inline size_t txFree() const
+    {
+        return impl()->txFree();
+    }
+    ///@}
+
+    ///@name Non-blocking read
+    ///@{
+    //! @brief Gets the number of bytes received and not yet read
+    inline size_t available()
+    {
+        return impl()->available();
+    }
+    /*!
+      @brief Read what is already received without waiting
+      @param[out] data Output buffer
+      @param len Maximum number of bytes to read
+      @return Number of bytes read (0 if nothing received)
+      @note Unlike readWithTransaction, returns partial data instead of TIMEOUT_ERROR
+     */
+    inline size_t readAvailable(uint8_t* data, const size_t len)
+    {
+        return impl()->readAvailable(data, len);
+    }
+    ///@}
+
+    /*!
+      @brief Read the next whole frame
+      @param framer Framer that holds the settings and the received data
+      @param[out] frame View of the frame (into the buffer of the framer)
+      @return True if a whole frame was extracted
+      @details Does not wait. Takes what is already received and returns false if no whole frame yet.
+      On ESP-IDF, a single byte delimiter is detected by the UART pattern detection
+      instead of scanning the stream (except event-driven RX)
+      @warning The frame is valid until the next readFrame with the same framer
+     */
+    inline bool readFrame(UARTFramer& framer, uart::frame_t& frame)
+    {
+        return impl()->readFrame(framer, frame);
+    }
+
+#if defined(ESP_PLATFORM) || defined(DOXYGEN_PROCESS)
+    ///@name Event-driven RX
+    ///@{
+    /*!
+      @brief Begin event-driven RX
+      @param buffer_size Size of the receive buffer of this adapter
+      @return True if successful
+      @details Received data is pushed to the buffer of this adapter in the background
+      (UART reader task on ESP-IDF, HardwareSerial::onReceive on Arduino).
+      readWithTransaction then reads from the buffer, and rxReady() tells whether data is waiting,
+      so update() does not need to block on the UART
+     */
+    inline bool beginEventRX(const size_t buffer_size = 1024)
+    {
+        return impl()->beginEventRX(buffer_size);
+    }
+    //! @brief End event-driven RX
+    inline void endEventRX()
+    {
+        impl()->endEventRX();
+    }
+    //! @brief Is event-driven RX running?
+    inline bool eventRX() const
+    {
+        return impl()->eventRX();
+    }
+    //! @brief Is received data waiting in the buffer?
+    inline bool rxReady() const
+    {
+        return impl()->rxReady();
+    }
+    //! @brief Gets the number of bytes dropped due to the buffer full
+    inline uint32_t rxDropped() const
+    {
+        return impl()->rxDropped();
+    }
+    /*!
+      @brief Set the callback called when data is received
+      @warning Called in the receiver context (not the caller of update). Keep it short
+     */
+    inline void setRXCallback(std::function<void()> cb)
+    {
+        impl()->setRXCallback(cb);
+    }
+    ///@}
+
+    ///@name Streaming RX
+    ///@{
+    /*!
+      @brief Begin streaming RX for high baud rate
+      @param buffer_size Size of each receive buffer
+      @param buffers Number of the buffers (2: ping-pong, up to MAX_STREAM_BUFFERS)
+      @return True if successful
+      @details The receiver task reads the UART in large blocks into the buffers in turn.
+      A buffer is handed over when it is full, or when the line is idle with some data in it.
+      If no buffer is free, received data is discarded and counted as overruns
+      @note ESP-IDF backend only. Cannot be used with event-driven RX
+      @note Data is still copied once from the driver ring buffer into the buffers (UHCI/GDMA is not used).
+      This saves the per-call overhead of small reads and the copy to the component, not the driver copy
+     */
+    inline bool beginStreamRX(const size_t buffer_size = 4096, const uint8_t buffers = 2)
+    {
+        return impl()->beginStreamRX(buffer_size, buffers);
+    }
+    //! @brief End streaming RX
+    inline void endStreamRX()
+    {
+        impl()->endStreamRX();
+    }
+    //! @brief Is streaming RX running?
+    inline bool streamRX() const
+    {
+        return impl()->streamRX();
+    }
+    /*!
+      @brief Borrow the next filled buffer
+      @param[out] len Length of the data
+      @param timeout_ms Time to wait for a buffer
+      @return Pointer to the data, nullptr if no buffer filled
+      @warning Call releaseStream when done, the buffer is not refilled until then
+     */
+    inline const uint8_t* acquireStream(size_t& len, const uint32_t timeout_ms = 0)
+    {
+        return impl()->acquireStream(len, timeout_ms);
+    }
+    //! @brief Return the buffer borrowed by acquireStream
+    inline void releaseStream(const uint8_t* buf)
+    {
+        impl()->releaseStream(buf);
+    }
+    //! @brief Gets the number of bytes discarded because no buffer was free
+    inline uint32_t streamOverruns() const
+    {
+        return impl()->streamOverruns();
+    }
+    ///@}
+#endif
+
     inline UARTImpl* impl()
     {
         return static_cast<UARTImpl*>(_impl.get());
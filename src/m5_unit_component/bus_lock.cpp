@@ -0,0 +1,180 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file bus_lock.cpp
+  @brief Per physical bus lock for sharing a bus between tasks
+*/
+#include "bus_lock.hpp"
+#include <M5Utility.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+#if defined(ESP_PLATFORM)
+#include <esp_timer.h>
+#endif
+
+namespace m5 {
+namespace unit {
+
+namespace {
+std::mutex registry_mutex{};
+std::vector<std::unique_ptr<BusLock>> registry{};
+}  // namespace
+
+BusLock* BusLock::get(const void* key)
+{
+    if (!key) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto&& bl : registry) {
+        if (bl->key() == key) {
+            return bl.get();
+        }
+    }
+    std::unique_ptr<BusLock> bl{new BusLock(key)};
+#if defined(ESP_PLATFORM)
+    if (!bl->_mutex) {
+        M5_LIB_LOGE("Failed to create the bus lock");
+        return nullptr;
+    }
+#endif
+    registry.emplace_back(std::move(bl));
+    return registry.back().get();
+}
+
+BusLock::BusLock(const void* key) : _key{key}
+{
+#if defined(ESP_PLATFORM)
+    _mutex = xSemaphoreCreateMutex();  // Priority inheritance
+#endif
+}
+
+int64_t BusLock::now_us()
+{
+#if defined(ESP_PLATFORM)
+    return esp_timer_get_time();
+#else
+    return static_cast<int64_t>(m5::utility::micros());
+#endif
+}
+
+void BusLock::lock()
+{
+#if defined(ESP_PLATFORM)
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    if (_owner == self) {
+        ++_depth;
+        return;
+    }
+
+    const int64_t start = now_us();
+    bool contended{}, blocked{};
+    if (xSemaphoreTake(_mutex, 0) != pdTRUE) {
+        contended = true;
+        bool got{};
+#if portNUM_PROCESSORS > 1
+        // The holder may be running on the other core and release soon
+        // Spin on the owner (a plain read, no kernel call) and try to take only when it looks free
+        const int64_t limit = start + SPIN_US;
+        while (!got && now_us() < limit) {
+            if (!_owner) {
+                got = (xSemaphoreTake(_mutex, 0) == pdTRUE);
+            }
+        }
+#endif
+        if (!got) {
+            blocked = true;
+            xSemaphoreTake(_mutex, portMAX_DELAY);
+        }
+    }
+    _owner = self;
+#else
+    if (_depth) {
+        ++_depth;
+        return;
+    }
+    const int64_t start = now_us();
+    bool contended{}, blocked{};
+#endif
+    _depth      = 1;
+    _hold_start = now_us();
+
+    // Update while holding the lock
+    const uint32_t wait = static_cast<uint32_t>(_hold_start - start);
+    ++_stats.acquired;
+    _stats.contended += contended;
+    _stats.blocked += blocked;
+    ++_stats.wait_histogram[bus_lock_stats_t::bucket(wait)];
+    if (wait > _stats.max_wait_us) {
+        _stats.max_wait_us = wait;
+    }
+}
+
+void BusLock::unlock()
+{
+#if defined(ESP_PLATFORM)
+    if (_owner != xTaskGetCurrentTaskHandle() || !_depth) {
+        M5_LIB_LOGE("Unlock by non-owner");
+        return;
+    }
+#else
+    if (!_depth) {
+        M5_LIB_LOGE("Unlock by non-owner");
+        return;
+    }
+#endif
+    if (--_depth) {
+        return;
+    }
+
+    const uint32_t hold = static_cast<uint32_t>(now_us() - _hold_start);
+    ++_stats.hold_histogram[bus_lock_stats_t::bucket(hold)];
+    if (hold > _stats.max_hold_us) {
+        _stats.max_hold_us = hold;
+    }
+#if defined(ESP_PLATFORM)
+    _owner = nullptr;
+    xSemaphoreGive(_mutex);
+#endif
+}
+
+bus_lock_stats_t BusLock::stats() const
+{
+#if defined(ESP_PLATFORM)
+    // Taken directly so that reading does not count as an acquisition
+    const bool owned = (_owner == xTaskGetCurrentTaskHandle());
+    if (!owned) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
+    bus_lock_stats_t s = _stats;
+    if (!owned) {
+        xSemaphoreGive(_mutex);
+    }
+    return s;
+#else
+    return _stats;
+#endif
+}
+
+void BusLock::resetStats()
+{
+#if defined(ESP_PLATFORM)
+    const bool owned = (_owner == xTaskGetCurrentTaskHandle());
+    if (!owned) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+    }
+    _stats = bus_lock_stats_t{};
+    if (!owned) {
+        xSemaphoreGive(_mutex);
+    }
+#else
+    _stats = bus_lock_stats_t{};
+#endif
+}
+
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file bus_lock.hpp
+  @brief Per physical bus lock for sharing a bus between tasks
+*/
+#ifndef M5_UNIT_COMPONENT_BUS_LOCK_HPP
+#define M5_UNIT_COMPONENT_BUS_LOCK_HPP
+
+#include <cstdint>
+#include <cstddef>
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+namespace m5 {
+namespace unit {
+
+/*!
+  @struct bus_lock_stats_t
+  @brief Contention statistics of the bus lock
+  @details Histogram bucket [0] counts less than 1 us, bucket [n] counts [2^(n-1), 2^n) us,
+  and the last bucket counts everything above
+ */
+struct bus_lock_stats_t {
+    static constexpr uint8_t BUCKETS{16};  //!< Number of the histogram buckets
+    uint32_t acquired{};                   //!< Number of acquisitions (not including nesting)
+    uint32_t contended{};                  //!< Number of acquisitions that had to wait
+    uint32_t blocked{};                    //!< Number of acquisitions that blocked after spinning
+    uint32_t max_wait_us{};                //!< Maximum wait time (us)
+    uint32_t max_hold_us{};                //!< Maximum hold time (us)
+    uint32_t wait_histogram[BUCKETS]{};    //!< Wait time histogram
+    uint32_t hold_histogram[BUCKETS]{};    //!< Hold time histogram
+
+    //! @brief Gets the bucket index for the time
+    static uint8_t bucket(const uint32_t us)
+    {
+        uint8_t idx{};
+        uint32_t v{us};
+        while (v && idx < BUCKETS - 1) {
+            v >>= 1;
+            ++idx;
+        }
+        return idx;
+    }
+};
+
+/*!
+  @class m5::unit::BusLock
+  @brief Recursive lock for one physical bus
+  @details Try to take without blocking first. On multi-core targets, spin on the owner for up to SPIN_US while
+  the holder may release on the other core, then block with priority inheritance.
+  Nested locks by the owner task only increase the depth
+  @note Obtained by get() for each bus identity (I2C port, M5HAL bus, SPI bus...) and never destroyed
+ */
+class BusLock {
+public:
+    //! @brief Time to spin before blocking (us, multi-core only)
+    static constexpr uint32_t SPIN_US{20};
+
+    /*!
+      @brief Gets the lock for the bus
+      @param key Identity of the physical bus
+      @return Pointer to the lock, nullptr if key is nullptr or failed
+     */
+    static BusLock* get(const void* key);
+
+    //! @brief Acquire the lock
+    void lock();
+    //! @brief Release the lock
+    void unlock();
+
+    //! @brief Gets the identity of the bus
+    inline const void* key() const
+    {
+        return _key;
+    }
+    //! @brief Gets the snapshot of the statistics
+    bus_lock_stats_t stats() const;
+    //! @brief Reset the statistics
+    void resetStats();
+
+protected:
+    explicit BusLock(const void* key);
+    static int64_t now_us();
+
+private:
+    const void* _key{};
+#if defined(ESP_PLATFORM)
+    SemaphoreHandle_t _mutex{};
+    volatile TaskHandle_t _owner{};
+#endif
+    uint32_t _depth{};
+    int64_t _hold_start{};
+    bus_lock_stats_t _stats{};
+};
+
+//! @brief RAII guard for the bus lock (nullptr is allowed)
+struct bus_lock_guard {
+    explicit bus_lock_guard(BusLock* bl) : _bl{bl}
+    {
+        if (_bl) {
+            _bl->lock();
+        }
+    }
+    ~bus_lock_guard()
+    {
+        if (_bl) {
+            _bl->unlock();
+        }
+    }
+    bus_lock_guard(const bus_lock_guard&)            = delete;
+    bus_lock_guard& operator=(const bus_lock_guard&) = delete;
+    BusLock* _bl{};
+};
+
+}  // namespace unit
+}  // namespace m5
+#endif
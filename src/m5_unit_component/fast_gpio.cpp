@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file fast_gpio.cpp
+  @brief Fast GPIO access for bit-banged protocols
+  @todo Will be transferred to M5HAL in the future
+*/
+#include "fast_gpio.hpp"
+#include <M5Utility.hpp>
+#include <soc/soc_caps.h>
+#include <soc/gpio_reg.h>
+
+#if defined(SOC_DEDICATED_GPIO_SUPPORTED) && SOC_DEDICATED_GPIO_SUPPORTED && __has_include(<driver/dedic_gpio.h>)
+#define M5_UNIT_UNIFIED_USING_DEDIC_GPIO
+#include <driver/dedic_gpio.h>
+#endif
+
+namespace m5 {
+namespace unit {
+namespace gpio {
+
+namespace {
+inline volatile uint32_t* reg(const uint32_t addr)
+{
+    return reinterpret_cast<volatile uint32_t*>(addr);
+}
+
+// Registers of the bank (0: GPIO0-31, 1: GPIO32-)
+struct gpio_bank_t {
+    uint32_t out_set, out_clr, enable_set, enable_clr, in;
+};
+
+constexpr gpio_bank_t gpio_banks[] = {
+    {GPIO_OUT_W1TS_REG, GPIO_OUT_W1TC_REG, GPIO_ENABLE_W1TS_REG, GPIO_ENABLE_W1TC_REG, GPIO_IN_REG},
+#if defined(GPIO_OUT1_W1TS_REG)
+    {GPIO_OUT1_W1TS_REG, GPIO_OUT1_W1TC_REG, GPIO_ENABLE1_W1TS_REG, GPIO_ENABLE1_W1TC_REG, GPIO_IN1_REG},
+#endif
+};
+
+bool configure_pins(const uint64_t bits, const bool open_drain, const bool pullup)
+{
+    gpio_config_t cfg{};
+    cfg.pin_bit_mask = bits;
+    cfg.mode         = open_drain ? GPIO_MODE_INPUT_OUTPUT_OD : GPIO_MODE_INPUT_OUTPUT;
+    cfg.pull_up_en   = pullup ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+    cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    cfg.intr_type    = GPIO_INTR_DISABLE;
+    return gpio_config(&cfg) == ESP_OK;
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+bool FastPin::attach(const gpio_num_t pin)
+{
+    const size_t bank = static_cast<size_t>(pin) >> 5;
+    if (pin < 0 || !GPIO_IS_VALID_GPIO(pin) || bank >= m5::stl::size(gpio_banks)) {
+        *this = FastPin{};
+        return false;
+    }
+    const auto& b = gpio_banks[bank];
+    _out_set      = reg(b.out_set);
+    _out_clr      = reg(b.out_clr);
+    _enable_set   = reg(b.enable_set);
+    _enable_clr   = reg(b.enable_clr);
+    _in           = reg(b.in);
+    _mask         = 1U << (pin & 31);
+    _pin          = pin;
+    return true;
+}
+
+bool FastPin::configure(const bool open_drain, const bool pullup)
+{
+    return valid() && configure_pins(1ULL << _pin, open_drain, pullup);
+}
+
+// ----------------------------------------------------------------------------
+FastBundle::~FastBundle()
+{
+    end();
+}
+
+bool FastBundle::begin(const gpio_num_t* pins, const size_t count, const bool open_drain)
+{
+    end();
+    if (!pins || !count || count > max_pins) {
+        return false;
+    }
+
+    uint64_t bits{};
+    for (size_t i = 0; i < count; ++i) {
+        if (!_pins[i].attach(pins[i]) || (bits & (1ULL << pins[i]))) {
+            end();
+            return false;
+        }
+        bits |= 1ULL << pins[i];
+    }
+    if (!configure_pins(bits, open_drain, false)) {
+        end();
+        return false;
+    }
+    _count = count;
+
+#if defined(M5_UNIT_UNIFIED_USING_DEDIC_GPIO)
+    int gpios[max_pins]{};
+    for (size_t i = 0; i < count; ++i) {
+        gpios[i] = pins[i];
+    }
+    dedic_gpio_bundle_config_t cfg{};
+    cfg.gpio_array   = gpios;
+    cfg.array_size   = count;
+    cfg.flags.in_en  = 1;
+    cfg.flags.out_en = 1;
+    dedic_gpio_bundle_handle_t bundle{};
+    if (dedic_gpio_new_bundle(&cfg, &bundle) == ESP_OK) {
+        _bundle = bundle;
+    } else {
+        M5_LIB_LOGW("Dedicated GPIO is not available, use GPIO registers");
+    }
+#endif
+    return true;
+}
+
+void FastBundle::end()
+{
+#if defined(M5_UNIT_UNIFIED_USING_DEDIC_GPIO)
+    if (_bundle) {
+        dedic_gpio_del_bundle(static_cast<dedic_gpio_bundle_handle_t>(_bundle));
+    }
+#endif
+    _bundle = nullptr;
+    _count  = 0;
+    for (auto&& p : _pins) {
+        p = FastPin{};
+    }
+}
+
+void FastBundle::write(const uint32_t mask, const uint32_t value) const
+{
+#if defined(M5_UNIT_UNIFIED_USING_DEDIC_GPIO)
+    if (_bundle) {
+        dedic_gpio_bundle_write(static_cast<dedic_gpio_bundle_handle_t>(_bundle), mask, value);
+        return;
+    }
+#endif
+    // Collect the bits for each bank and write them at once
+    uint32_t set[m5::stl::size(gpio_banks)]{}, clr[m5::stl::size(gpio_banks)]{};
+    for (size_t i = 0; i < _count; ++i) {
+        if (mask & (1U << i)) {
+            const auto pin = _pins[i].pin();
+            ((value & (1U << i)) ? set : clr)[pin >> 5] |= 1U << (pin & 31);
+        }
+    }
+    for (size_t b = 0; b < m5::stl::size(gpio_banks); ++b) {
+        if (set[b]) {
+            *reg(gpio_banks[b].out_set) = set[b];
+        }
+        if (clr[b]) {
+            *reg(gpio_banks[b].out_clr) = clr[b];
+        }
+    }
+}
+
+uint32_t FastBundle::read() const
+{
+#if defined(M5_UNIT_UNIFIED_USING_DEDIC_GPIO)
+    if (_bundle) {
+        return dedic_gpio_bundle_read_in(static_cast<dedic_gpio_bundle_handle_t>(_bundle));
+    }
+#endif
+    uint32_t v{};
+    for (size_t i = 0; i < _count; ++i) {
+        v |= _pins[i].read() ? (1U << i) : 0U;
+    }
+    return v;
+}
+
+}  // namespace gpio
+}  // namespace unit
+}  // namespace m5
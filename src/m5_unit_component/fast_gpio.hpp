@@ -0,0 +1,168 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file fast_gpio.hpp
+  @brief Fast GPIO access for bit-banged protocols
+  @todo Will be transferred to M5HAL in the future
+*/
+#ifndef M5_UNIT_COMPONENT_FAST_GPIO_HPP
+#define M5_UNIT_COMPONENT_FAST_GPIO_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <driver/gpio.h>
+
+namespace m5 {
+namespace unit {
+namespace gpio {
+
+/*!
+  @class m5::unit::gpio::FastPin
+  @brief Single pin accessed by the pre-resolved GPIO registers
+  @details The registers and the mask are resolved when attached, so each access is one register write or read
+  without the driver calls and the pin mode is not configured again on the direction change
+  @code
+  m5::unit::gpio::FastPin pin(GPIO_NUM_26);
+  pin.configure(true, true);  // Open drain and pull-up (e.g. 1-Wire)
+  pin.low();
+  ...
+  pin.input();  // Release
+  bool level = pin.read();
+  @endcode
+ */
+class FastPin {
+public:
+    FastPin() = default;
+    //! @brief Attach the pin (the pin mode is not configured)
+    explicit FastPin(const gpio_num_t pin)
+    {
+        attach(pin);
+    }
+
+    //! @brief Resolve the registers of the pin
+    bool attach(const gpio_num_t pin);
+    /*!
+      @brief Configure the pin as input and output once
+      @param open_drain Open drain output if true
+      @param pullup Enable the internal pull-up
+      @details The input stays enabled, so the level can be read in both directions
+      @note The output is enabled after configured
+     */
+    bool configure(const bool open_drain = false, const bool pullup = false);
+
+    //! @brief Is the pin attached?
+    inline bool valid() const
+    {
+        return _mask != 0;
+    }
+    //! @brief Gets the pin
+    inline gpio_num_t pin() const
+    {
+        return _pin;
+    }
+
+    ///@name Level
+    ///@{
+    inline void high() const
+    {
+        *_out_set = _mask;
+    }
+    inline void low() const
+    {
+        *_out_clr = _mask;
+    }
+    inline void write(const bool high) const
+    {
+        *(high ? _out_set : _out_clr) = _mask;
+    }
+    inline bool read() const
+    {
+        return (*_in & _mask) != 0;
+    }
+    ///@}
+
+    ///@name Direction
+    ///@{
+    //! @brief Enable the output
+    inline void output() const
+    {
+        *_enable_set = _mask;
+    }
+    //! @brief Disable the output (input only, the line is released)
+    inline void input() const
+    {
+        *_enable_clr = _mask;
+    }
+    ///@}
+
+private:
+    volatile uint32_t* _out_set{};
+    volatile uint32_t* _out_clr{};
+    volatile uint32_t* _enable_set{};
+    volatile uint32_t* _enable_clr{};
+    volatile const uint32_t* _in{};
+    uint32_t _mask{};
+    gpio_num_t _pin{GPIO_NUM_NC};
+};
+
+/*!
+  @class m5::unit::gpio::FastBundle
+  @brief Pins written and read together
+  @details Uses the dedicated GPIO (CPU instructions) if SOC_DEDICATED_GPIO_SUPPORTED,
+  and the GPIO registers (each bank written at once) otherwise
+  @warning The dedicated GPIO bundle is bound to the core that called begin, use it on the same core
+ */
+class FastBundle {
+public:
+    //! @brief Maximum number of the pins
+    static constexpr size_t max_pins{8};
+
+    FastBundle() = default;
+    ~FastBundle();
+    FastBundle(const FastBundle&)            = delete;
+    FastBundle& operator=(const FastBundle&) = delete;
+
+    /*!
+      @brief Configure the pins as the bundle
+      @param pins Pins, bit i of the mask and the value is pins[i]
+      @param count Number of the pins (up to max_pins)
+      @param open_drain Open drain output if true
+      @return True if successful
+     */
+    bool begin(const gpio_num_t* pins, const size_t count, const bool open_drain = false);
+    //! @brief Release the bundle
+    void end();
+
+    //! @brief Is the dedicated GPIO used?
+    inline bool dedicated() const
+    {
+        return _bundle != nullptr;
+    }
+    //! @brief Gets the number of the pins
+    inline size_t count() const
+    {
+        return _count;
+    }
+
+    /*!
+      @brief Write the levels
+      @param mask Bits of the pins written
+      @param value Levels
+     */
+    void write(const uint32_t mask, const uint32_t value) const;
+    //! @brief Read the levels
+    uint32_t read() const;
+
+private:
+    FastPin _pins[max_pins]{};
+    size_t _count{};
+    void* _bundle{};  // dedic_gpio_bundle_handle_t
+};
+
+}  // namespace gpio
+}  // namespace unit
+}  // namespace m5
+#endif
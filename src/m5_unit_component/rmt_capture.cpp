@@ -0,0 +1,210 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file rmt_capture.cpp
+  @brief Compressed storage for RMT captures
+*/
+#include "rmt_capture.hpp"
+
+/*
+  Format (per tag byte)
+  1nnnnnnn                    : Repeat the previous item n+1 times
+  01iiiiii                    : Item i of the dictionary
+  00ab0000 <varint> <varint>  : Literal item (level0 a, level1 b, duration0, duration1), added to the dictionary
+ */
+namespace m5 {
+namespace unit {
+namespace gpio {
+
+namespace {
+constexpr uint8_t tag_repeat{0x80};
+constexpr uint8_t tag_dictionary{0x40};
+constexpr uint8_t max_repeat{0x7F};  // n
+
+inline size_t varint_size(const uint32_t v)
+{
+    return (v < 0x80) ? 1 : (v < 0x4000) ? 2 : 3;
+}
+
+inline void put_varint(std::vector<uint8_t>& buf, uint32_t v)
+{
+    while (v >= 0x80) {
+        buf.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    buf.push_back(static_cast<uint8_t>(v));
+}
+
+inline bool get_varint(const uint8_t* data, const size_t len, size_t& pos, uint32_t& v)
+{
+    v = 0;
+    for (uint_fast8_t shift = 0; pos < len && shift < 21; shift += 7) {
+        const uint8_t b = data[pos++];
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint32_t difference(const uint32_t a, const uint32_t b)
+{
+    return (a > b) ? a - b : b - a;
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+RMTCaptureWriter::RMTCaptureWriter(const size_t capacity, const uint16_t tolerance)
+    : _capacity{capacity}, _tolerance{tolerance}
+{
+    _buf.reserve(capacity);
+}
+
+void RMTCaptureWriter::clear()
+{
+    _buf.clear();
+    _count    = 0;
+    _run_pos  = 0;
+    _has_prev = false;
+    _dict.clear();
+}
+
+bool RMTCaptureWriter::same(const m5_rmt_item_t& a, const m5_rmt_item_t& b) const
+{
+    return a.level0 == b.level0 && a.level1 == b.level1 && difference(a.duration0, b.duration0) <= _tolerance &&
+           difference(a.duration1, b.duration1) <= _tolerance;
+}
+
+int RMTCaptureWriter::find(const m5_rmt_item_t& item) const
+{
+    for (uint_fast8_t i = 0; i < _dict.count; ++i) {
+        if (same(_dict.items[i], item)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool RMTCaptureWriter::append(const m5_rmt_item_t& item)
+{
+    // Repeat
+    if (_has_prev && same(_prev, item)) {
+        if (_run_pos && (_buf[_run_pos - 1] & max_repeat) < max_repeat) {
+            ++_buf[_run_pos - 1];
+            return true;
+        }
+        if (_buf.size() + 1 > _capacity) {
+            return false;
+        }
+        _buf.push_back(tag_repeat);
+        _run_pos = _buf.size();
+        return true;
+    }
+
+    // Dictionary
+    const int idx = find(item);
+    if (idx >= 0) {
+        if (_buf.size() + 1 > _capacity) {
+            return false;
+        }
+        _buf.push_back(tag_dictionary | idx);
+        _prev = _dict.items[idx];  // As the reader decodes
+    } else {
+        // Literal
+        if (_buf.size() + 1 + varint_size(item.duration0) + varint_size(item.duration1) > _capacity) {
+            return false;
+        }
+        _buf.push_back((item.level0 ? 0x20 : 0) | (item.level1 ? 0x10 : 0));
+        put_varint(_buf, item.duration0);
+        put_varint(_buf, item.duration1);
+        _dict.add(item);
+        _prev = item;
+    }
+    _has_prev = true;
+    _run_pos  = 0;
+    return true;
+}
+
+size_t RMTCaptureWriter::append(const m5_rmt_item_t* items, const size_t count)
+{
+    size_t n{};
+    if (items) {
+        while (n < count && append(items[n])) {
+            ++n;
+        }
+    }
+    _count += n;
+    return n;
+}
+
+// ----------------------------------------------------------------------------
+RMTCaptureReader::RMTCaptureReader(const uint8_t* data, const size_t len) : _data{data}, _len{data ? len : 0}
+{
+}
+
+void RMTCaptureReader::rewind()
+{
+    _pos    = 0;
+    _repeat = 0;
+    _dict.clear();
+}
+
+bool RMTCaptureReader::next(m5_rmt_item_t& item)
+{
+    if (!_repeat) {
+        if (_pos >= _len) {
+            return false;
+        }
+        const uint8_t tag = _data[_pos++];
+        if (tag & tag_repeat) {
+            _repeat = (tag & max_repeat) + 1;
+        } else if (tag & tag_dictionary) {
+            const uint8_t idx = tag & ~tag_dictionary;
+            if (idx >= _dict.count) {
+                _pos = _len;  // Broken
+                return false;
+            }
+            _prev = _dict.items[idx];
+            item  = _prev;
+            return true;
+        } else {
+            uint32_t d0{}, d1{};
+            if (!get_varint(_data, _len, _pos, d0) || !get_varint(_data, _len, _pos, d1)) {
+                _pos = _len;  // Broken
+                return false;
+            }
+            m5_rmt_item_t lit{};
+            lit.level0    = (tag & 0x20) ? 1 : 0;
+            lit.level1    = (tag & 0x10) ? 1 : 0;
+            lit.duration0 = d0;
+            lit.duration1 = d1;
+            _dict.add(lit);
+            _prev = lit;
+            item  = _prev;
+            return true;
+        }
+    }
+    --_repeat;
+    item = _prev;
+    return true;
+}
+
+size_t RMTCaptureReader::read(m5_rmt_item_t* items, const size_t count)
+{
+    size_t n{};
+    if (items) {
+        while (n < count && next(items[n])) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+}  // namespace gpio
+}  // namespace unit
+}  // namespace m5
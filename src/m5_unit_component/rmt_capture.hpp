@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file rmt_capture.hpp
+  @brief Compressed storage for RMT captures
+*/
+#ifndef M5_UNIT_COMPONENT_RMT_CAPTURE_HPP
+#define M5_UNIT_COMPONENT_RMT_CAPTURE_HPP
+
+#include "types.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace m5 {
+namespace unit {
+namespace gpio {
+
+///@cond
+namespace detail {
+// Recently stored distinct items, shared by the writer and the reader to stay in step
+struct capture_dictionary_t {
+    static constexpr uint8_t SIZE{64};
+    m5_rmt_item_t items[SIZE]{};
+    uint8_t count{};
+    uint8_t next{};  // Replaced next
+
+    inline void clear()
+    {
+        count = next = 0;
+    }
+    inline void add(const m5_rmt_item_t& item)
+    {
+        items[next] = item;
+        next        = (next + 1) % SIZE;
+        if (count < SIZE) {
+            ++count;
+        }
+    }
+};
+}  // namespace detail
+///@endcond
+
+/*!
+  @class m5::unit::gpio::RMTCaptureWriter
+  @brief Stores the received items in compressed form
+  @details Repeats of the previous item are run-length encoded and the items seen recently are stored as one byte
+  reference. Captures such as IR remotes take 1 byte or less per item instead of 4 bytes
+  @note Durations within the tolerance are regarded as the same (lossy if tolerance > 0)
+  @code
+  m5::unit::gpio::RMTCaptureWriter capture(4096, 8);
+  while (capture.available() && adapter->captureFrame(capture, 100)) {
+  }
+  m5::unit::gpio::RMTCaptureReader reader(capture.data(), capture.size());
+  m5::unit::gpio::m5_rmt_item_t item{};
+  while (reader.next(item)) { ... }
+  @endcode
+ */
+class RMTCaptureWriter {
+public:
+    /*!
+      @param capacity Maximum bytes stored
+      @param tolerance Duration difference regarded as the same (ticks)
+     */
+    explicit RMTCaptureWriter(const size_t capacity, const uint16_t tolerance = 0);
+
+    /*!
+      @brief Append the items
+      @return Number of the items appended, less than count if the storage is full
+     */
+    size_t append(const m5_rmt_item_t* items, const size_t count);
+    //! @brief Discard all stored items
+    void clear();
+
+    //! @brief Gets the stored data
+    inline const uint8_t* data() const
+    {
+        return _buf.data();
+    }
+    //! @brief Gets the stored data size (bytes)
+    inline size_t size() const
+    {
+        return _buf.size();
+    }
+    //! @brief Gets the number of the stored items
+    inline size_t count() const
+    {
+        return _count;
+    }
+    //! @brief Is there room to store at least one item?
+    inline bool available() const
+    {
+        return _buf.size() + max_item_size <= _capacity;
+    }
+    //! @brief Gets the compression ratio (raw size / stored size)
+    inline float ratio() const
+    {
+        return _buf.empty() ? 0.0f : static_cast<float>(_count * sizeof(m5_rmt_item_t)) / _buf.size();
+    }
+
+    //! @brief Maximum bytes for an item
+    static constexpr size_t max_item_size{7};
+
+protected:
+    bool same(const m5_rmt_item_t& a, const m5_rmt_item_t& b) const;
+    int find(const m5_rmt_item_t& item) const;
+    bool append(const m5_rmt_item_t& item);
+
+private:
+    std::vector<uint8_t> _buf{};
+    size_t _capacity{};
+    size_t _count{};
+    size_t _run_pos{};  // Position of the repeat tag being counted + 1 (0: None)
+    uint16_t _tolerance{};
+    m5_rmt_item_t _prev{};  // As the reader decodes
+    bool _has_prev{};
+    detail::capture_dictionary_t _dict{};
+};
+
+/*!
+  @class m5::unit::gpio::RMTCaptureReader
+  @brief Streaming decoder for RMTCaptureWriter data
+  @note The data must remain valid while reading
+ */
+class RMTCaptureReader {
+public:
+    RMTCaptureReader(const uint8_t* data, const size_t len);
+
+    //! @brief Gets the next item
+    bool next(m5_rmt_item_t& item);
+    /*!
+      @brief Gets the items
+      @return Number of the items decoded
+     */
+    size_t read(m5_rmt_item_t* items, const size_t count);
+    //! @brief Decode from the beginning
+    void rewind();
+
+private:
+    const uint8_t* _data{};
+    size_t _len{}, _pos{};
+    uint8_t _repeat{};  // Repeats of _prev left
+    m5_rmt_item_t _prev{};
+    detail::capture_dictionary_t _dict{};
+};
+
+}  // namespace gpio
+}  // namespace unit
+}  // namespace m5
+#endif
@@ -0,0 +1,186 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file transaction.hpp
+  @brief Transaction builder for multi-op command lists
+*/
+#ifndef M5_UNIT_COMPONENT_TRANSACTION_HPP
+#define M5_UNIT_COMPONENT_TRANSACTION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+namespace m5 {
+namespace unit {
+namespace transaction {
+
+//! @brief Operation type
+enum class OpType : uint8_t {
+    Write,       //!< Write data
+    WriteReg8,   //!< Write 8-bit register and data
+    WriteReg16,  //!< Write 16-bit register (big-endian) and data
+    Read,        //!< Read data
+    Delay,       //!< Wait
+};
+
+/*!
+  @struct op_t
+  @brief Recorded operation
+  @note A read always ends with STOP, stop is for the writes only
+ */
+struct op_t {
+    OpType type{};
+    bool stop{true};      //!< Issue STOP after write? (false: Next op begins with repeated START, I2C only)
+    uint16_t reg{};       //!< Register (WriteReg8/16)
+    const uint8_t* tx{};  //!< Write data
+    uint8_t* rx{};        //!< Read destination
+    size_t len{};         //!< Length of tx or rx
+    uint32_t delay_ms{};  //!< Wait time (Delay)
+};
+
+}  // namespace transaction
+
+/*!
+  @class m5::unit::TransactionBuilder
+  @brief Records the operations to be executed as one transaction
+  @details Executed by Component::executeTransaction with one channel selection and one bus acquisition
+  @code
+  uint8_t status{}, buf[32]{};
+  m5::unit::TransactionBuilder tb;
+  tb.write(cmd, sizeof(cmd)).delay(10).writeRegister(REG_STATUS, nullptr, 0).repeatedStart().read(&status, 1);
+  tb.read(buf, sizeof(buf));
+  unit.executeTransaction(tb);
+  @endcode
+  @warning Data is not copied. The buffers must remain valid until executed
+ */
+class TransactionBuilder {
+public:
+    TransactionBuilder() = default;
+    //! @brief Constructor that reserves space for the operations
+    explicit TransactionBuilder(const size_t reserve)
+    {
+        _ops.reserve(reserve);
+    }
+
+    /*!
+      @brief Write data
+      @param data Data to write
+      @param len Length of data
+      @param stop Issue STOP if true
+      @return Reference to self
+     */
+    TransactionBuilder& write(const uint8_t* data, const size_t len, const bool stop = true)
+    {
+        transaction::op_t op{};
+        op.type = transaction::OpType::Write;
+        op.tx   = data;
+        op.len  = len;
+        op.stop = stop;
+        _ops.push_back(op);
+        return *this;
+    }
+    /*!
+      @brief Write register and data
+      @tparam Reg Register type (uint8_t or uint16_t)
+      @param reg Register
+      @param data Data to write
+      @param len Length of data
+      @param stop Issue STOP if true
+      @return Reference to self
+     */
+    template <typename Reg,
+              typename std::enable_if<std::is_integral<Reg>::value && std::is_unsigned<Reg>::value && sizeof(Reg) <= 2,
+                                      std::nullptr_t>::type = nullptr>
+    TransactionBuilder& writeRegister(const Reg reg, const uint8_t* data = nullptr, const size_t len = 0U,
+                                      const bool stop = true)
+    {
+        transaction::op_t op{};
+        op.type = (sizeof(Reg) == 2) ? transaction::OpType::WriteReg16 : transaction::OpType::WriteReg8;
+        op.reg  = reg;
+        op.tx   = data;
+        op.len  = len;
+        op.stop = stop;
+        _ops.push_back(op);
+        return *this;
+    }
+    /*!
+      @brief Read data
+      @param data Destination
+      @param len Length to read
+      @return Reference to self
+     */
+    TransactionBuilder& read(uint8_t* data, const size_t len)
+    {
+        transaction::op_t op{};
+        op.type = transaction::OpType::Read;
+        op.rx   = data;
+        op.len  = len;
+        _ops.push_back(op);
+        return *this;
+    }
+    /*!
+      @brief Wait
+      @param ms Wait time (ms)
+      @return Reference to self
+     */
+    TransactionBuilder& delay(const uint32_t ms)
+    {
+        transaction::op_t op{};
+        op.type     = transaction::OpType::Delay;
+        op.delay_ms = ms;
+        _ops.push_back(op);
+        return *this;
+    }
+    /*!
+      @brief The last write does not issue STOP, and the next op begins with repeated START
+      @return Reference to self
+      @note I2C only. Some backends support it only when followed by read (NOT_IMPLEMENTED otherwise)
+     */
+    TransactionBuilder& repeatedStart()
+    {
+        if (!_ops.empty() && is_write(_ops.back().type)) {
+            _ops.back().stop = false;
+        }
+        return *this;
+    }
+
+    //! @brief Clear all operations
+    inline void clear()
+    {
+        _ops.clear();
+    }
+    //! @brief Any operations?
+    inline bool empty() const
+    {
+        return _ops.empty();
+    }
+    //! @brief Gets the number of operations
+    inline size_t size() const
+    {
+        return _ops.size();
+    }
+    //! @brief Gets the operations
+    inline const transaction::op_t* data() const
+    {
+        return _ops.data();
+    }
+
+protected:
+    static inline bool is_write(const transaction::OpType t)
+    {
+        return t == transaction::OpType::Write || t == transaction::OpType::WriteReg8 ||
+               t == transaction::OpType::WriteReg16;
+    }
+
+private:
+    std::vector<transaction::op_t> _ops{};
+};
+
+}  // namespace unit
+}  // namespace m5
+#endif
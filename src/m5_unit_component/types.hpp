@@ -11,7 +11,9 @@
 #define M5_UNIT_COMPONENT_TYPES_HPP
 
 #include <cstdint>
+#include <cstddef>
 #include <type_traits>
+#include <vector>
 #include "identify_functions.hpp"
 #if defined(M5_UNIT_UNIFIED_USING_RMT_V2)
 #include <driver/rmt_types.h>
@@ -98,11 +100,28 @@ struct adapter_config_t {
     };
     //! @brief For RX
     struct rx_config_t : config_t {
-        uint16_t ring_buffer_size{};        ///< Ring buffer size for RX (bytes, v1 only)
+        uint16_t ring_buffer_size{};        ///< Ring buffer size for RX (bytes, v1), Size of each receive buffer (v2)
+        uint8_t buffer_count{2};            ///< Number of the receive buffers lent in turn (v2 only)
         uint16_t filter_ticks_threshold{};  ///< Filter: min valid pulse duration (in ticks)
         uint16_t idle_ticks_threshold{};    ///< RX idle threshold (in ticks for v1, in us for v2)
         bool filter_enabled{};              ///< Enable input signal filter
+        uint32_t read_timeout_ms{50};       ///< Time readWithTransaction waits for the reception
         //        bool eof_flag{};                    ///< Use RX EOF detection via timeout (v2 feature)
+
+        //! @brief Receive worker (v2 only)
+        struct worker_config_t {
+            bool dedicated{};           ///< Own task and queue if true, shared by all RX adapters otherwise
+            int8_t core{0};             ///< Core affinity (-1: no affinity)
+            uint8_t priority{2};        ///< Task priority
+            uint16_t queue_depth{16};   ///< Depth of the event queue
+            uint32_t stack_size{8192};  ///< Task stack size
+        };
+        /*!
+          @note The shared worker is created with the settings of the first adapter.
+          core, priority, queue_depth and stack_size of the later adapters are ignored (warned).
+          Use dedicated to apply them
+        */
+        worker_config_t worker{};
     };
 
     Mode mode{};       ///< Operating mode (RmtRX, RmtTX, RmtRXTX)
@@ -110,6 +129,70 @@ struct adapter_config_t {
     tx_config_t tx{};  ///< For TX
 };
 
+/*!
+  @struct m5::unit::gpio::rx_worker_stats_t
+  @brief Metrics of the receive worker (v2 only)
+*/
+struct rx_worker_stats_t {
+    uint32_t events{};            ///< Number of the receive events handled
+    uint32_t queue_overflows{};   ///< Number of the events lost because the queue was full
+    uint16_t queue_high_water{};  ///< Maximum number of the events waiting in the queue
+    uint32_t last_latency_us{};   ///< Latency from the ISR to the worker of the last event (us)
+    uint32_t max_latency_us{};    ///< Maximum latency from the ISR to the worker (us)
+};
+
+/*!
+  @struct m5::unit::gpio::pwm_config_t
+  @brief PWM output by LEDC (writeAnalogRX/TX)
+*/
+struct pwm_config_t {
+    uint32_t frequency_hz{5000};  ///< PWM frequency (Hz)
+    uint8_t resolution_bits{8};   ///< Duty resolution (bits), the value written is 0 - 2^bits
+    bool invert{};                ///< Invert the output
+};
+
+/*!
+  @struct m5::unit::gpio::pin_step_t
+  @brief Step of the level sequence (writeSequenceRX/TX)
+*/
+struct pin_step_t {
+    uint32_t hold_ns{};  ///< Time until the next step (ns)
+    bool level{};        ///< Level driven
+    bool release{};      ///< Disable the output (the line is released, level is ignored)
+};
+
+/*!
+  @struct m5::unit::gpio::pulse_capture_config_t
+  @brief Pulse capture by RMT RX
+*/
+struct pulse_capture_config_t {
+    bool level{true};            ///< Level of the pulses measured (true: HIGH)
+    uint32_t timeout_us{30000};  ///< A capture ends when the level does not change for this time (up to 32767)
+    uint16_t max_pulses{16};     ///< Maximum number of the pulses in a capture
+};
+
+/*!
+  @struct m5::unit::gpio::adc_continuous_config_t
+  @brief Continuous (DMA) ADC sampling
+*/
+struct adc_continuous_config_t {
+    std::vector<gpio_num_t> pins{};  ///< Scan pattern (ADC1 pins), RX pin if empty
+    uint32_t sample_rate_hz{20000};  ///< Conversions per second (shared by the pins in the pattern)
+    uint16_t average{1};             ///< Number of the conversions averaged into one sample of each pin
+    uint8_t iir_filter{};            ///< Hardware IIR filter coefficient (2,4,8,16,64) if supported, 0: Disabled
+    uint16_t frame_samples{64};      ///< Conversions for each DMA frame
+    uint16_t buffer_samples{1024};   ///< Conversions buffered until drained
+};
+
+/*!
+  @struct m5::unit::gpio::adc_sample_t
+  @brief Sample of the continuous ADC
+*/
+struct adc_sample_t {
+    uint8_t index{};   ///< Index of the pin in the scan pattern
+    uint16_t value{};  ///< Raw value
+};
+
 // Alias
 #if defined(M5_UNIT_UNIFIED_USING_RMT_V2)
 using m5_rmt_item_t = rmt_symbol_word_t;  //!< Alias for RMT item
@@ -117,6 +200,42 @@ using m5_rmt_item_t = rmt_symbol_word_t;  //!< Alias for RMT item
 using m5_rmt_item_t = rmt_item32_t;  //!< Alias for RMT item
 #endif
 
+//! @brief Wait until received (for receiveFrame)
+constexpr uint32_t wait_forever{0xFFFFFFFFU};
+
+/*!
+  @struct m5::unit::gpio::rmt_frame_t
+  @brief View of the received RMT frame
+  @warning Valid until releaseFrame
+*/
+struct rmt_frame_t {
+    const m5_rmt_item_t* symbols{};  ///< Received items
+    size_t count{};                  ///< Number of the items
+    int64_t timestamp_us{};          ///< Time of the capture (esp_timer_get_time)
+    bool overflow{};                 ///< The buffer was filled, the frame may be truncated
+};
+
+/*!
+  @struct m5::unit::gpio::bytes_encoder_config_t
+  @brief Bytes encoder (each payload bit is sent as one RMT item)
+*/
+struct bytes_encoder_config_t {
+    m5_rmt_item_t bit0{};  ///< Item for bit 0
+    m5_rmt_item_t bit1{};  ///< Item for bit 1
+    bool msb_first{true};  ///< Send MSB first
+};
+
+/*!
+  @struct m5::unit::gpio::composite_encoder_config_t
+  @brief Composite encoder (fixed header, bytes encoded payload and fixed trailer)
+  @details e.g. NEC IR: header is the leading pulse, trailer is the ending pulse
+*/
+struct composite_encoder_config_t {
+    std::vector<m5_rmt_item_t> header{};   ///< Items sent before the payload
+    bytes_encoder_config_t payload{};      ///< Encoding of the payload
+    std::vector<m5_rmt_item_t> trailer{};  ///< Items sent after the payload
+};
+
 }  // namespace gpio
 
 }  // namespace unit
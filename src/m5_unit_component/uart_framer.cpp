@@ -0,0 +1,228 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file uart_framer.cpp
+  @brief Frame extraction for UART byte streams
+*/
+#include "uart_framer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace m5 {
+namespace unit {
+
+namespace {
+constexpr size_t npos{static_cast<size_t>(-1)};
+constexpr size_t min_buffer_size{16};
+}  // namespace
+
+UARTFramer::UARTFramer(const uart::framer_config_t& cfg)
+{
+    config(cfg);
+}
+
+void UARTFramer::config(const uart::framer_config_t& cfg)
+{
+    _cfg               = cfg;
+    _cfg.delimiter_len = std::min<uint8_t>(std::max<uint8_t>(_cfg.delimiter_len, 1), sizeof(_cfg.delimiter));
+    _cfg.sync_len      = std::min<uint8_t>(_cfg.sync_len, sizeof(_cfg.sync));
+    _cfg.length_size   = (_cfg.length_size == 2) ? 2 : 1;
+    if (_cfg.mode == uart::FrameMode::SyncWord && !_cfg.sync_len) {
+        _cfg.sync_len = 1;  // At least one byte is required
+    }
+    if (_cfg.mode == uart::FrameMode::SyncWord && _cfg.frame_size) {
+        // The buffer must hold a whole fixed size frame, or it is never completed
+        _cfg.frame_size = std::max<uint16_t>(_cfg.frame_size, _cfg.sync_len);
+        _cfg.max_frame  = std::max(_cfg.max_frame, _cfg.frame_size);
+    }
+    // Holds a whole frame and the following data
+    _buf.assign(std::max<size_t>(_cfg.max_frame * 2U, min_buffer_size), 0);
+    _dropped = 0;
+    clear();
+}
+
+void UARTFramer::clear()
+{
+    _head = _tail = _scan = 0;
+}
+
+void UARTFramer::compact()
+{
+    if (_head) {
+        std::memmove(_buf.data(), _buf.data() + _head, _tail - _head);
+        _tail -= _head;
+        _scan -= std::min(_scan, _head);
+        _head = 0;
+    }
+}
+
+void UARTFramer::drop(const size_t len)
+{
+    _head += len;
+    _dropped += len;
+    _scan = std::max(_scan, _head);
+}
+
+uint8_t* UARTFramer::prepare(size_t& capacity)
+{
+    compact();
+    if (_tail == _buf.size()) {
+        // Full without a frame, discard the oldest
+        drop(std::min<size_t>(_cfg.max_frame, _tail));
+        compact();
+    }
+    capacity = _buf.size() - _tail;
+    return _buf.data() + _tail;
+}
+
+void UARTFramer::commit(const size_t len)
+{
+    _tail = std::min(_tail + len, _buf.size());
+}
+
+size_t UARTFramer::feed(const uint8_t* data, const size_t len)
+{
+    if (!data) {
+        return 0;
+    }
+    size_t cap{};
+    auto p         = prepare(cap);
+    const size_t n = std::min(cap, len);
+    std::memcpy(p, data, n);
+    commit(n);
+    return n;
+}
+
+size_t UARTFramer::find(const uint8_t* pat, const size_t plen, const size_t from) const
+{
+    size_t pos = from;
+    while (pos + plen <= _tail) {
+        auto p = static_cast<const uint8_t*>(std::memchr(_buf.data() + pos, pat[0], _tail - pos - plen + 1));
+        if (!p) {
+            break;
+        }
+        pos = p - _buf.data();
+        if (std::memcmp(p, pat, plen) == 0) {
+            return pos;
+        }
+        ++pos;
+    }
+    return npos;
+}
+
+// Discard the data before the sync word
+bool UARTFramer::align_sync()
+{
+    const size_t sl  = _cfg.sync_len;
+    const size_t pos = find(_cfg.sync, sl, _head);
+    if (pos == npos) {
+        // Keep the tail that may be the beginning of the sync word
+        const size_t keep = std::min(_tail - _head, sl - 1);
+        drop(_tail - _head - keep);
+        return false;
+    }
+    drop(pos - _head);
+    return true;
+}
+
+bool UARTFramer::next(uart::frame_t& frame)
+{
+    switch (_cfg.mode) {
+        case uart::FrameMode::Delimiter:
+            return next_delimiter(frame);
+        case uart::FrameMode::SyncWord:
+            return next_sync(frame);
+        case uart::FrameMode::LengthPrefix:
+            return next_length(frame);
+        default:
+            break;
+    }
+    return false;
+}
+
+bool UARTFramer::next_delimiter(uart::frame_t& frame)
+{
+    const size_t dl  = _cfg.delimiter_len;
+    const size_t pos = find(_cfg.delimiter, dl, std::max(_scan, _head));
+    if (pos != npos) {
+        frame.data = _buf.data() + _head;
+        frame.len  = pos - _head + (_cfg.include_delimiter ? dl : 0);
+        _head = _scan = pos + dl;
+        return true;
+    }
+    // Resume from here, keeping the tail that may be the beginning of the delimiter
+    _scan = std::max(_head, (_tail >= dl - 1) ? _tail - (dl - 1) : 0);
+    if (_scan - _head > _cfg.max_frame) {
+        drop(_scan - _head);
+    }
+    return false;
+}
+
+bool UARTFramer::next_sync(uart::frame_t& frame)
+{
+    if (!align_sync()) {
+        return false;
+    }
+    const size_t sl = _cfg.sync_len;
+    if (_cfg.frame_size) {
+        if (_tail - _head < _cfg.frame_size) {
+            return false;
+        }
+        frame.data = _buf.data() + _head;
+        frame.len  = _cfg.frame_size;
+        _head += _cfg.frame_size;
+        _scan = _head;
+        return true;
+    }
+
+    // Lasts until the next sync word
+    const size_t pos = find(_cfg.sync, sl, std::max(_scan, _head + sl));
+    if (pos == npos) {
+        _scan = std::max(_head + sl, (_tail >= sl - 1) ? _tail - (sl - 1) : 0);
+        if (_tail - _head > _cfg.max_frame) {
+            drop(sl);  // Skip this sync word and search the next one
+        }
+        return false;
+    }
+    frame.data = _buf.data() + _head;
+    frame.len  = pos - _head;
+    _head = _scan = pos;
+    return true;
+}
+
+bool UARTFramer::next_length(uart::frame_t& frame)
+{
+    const size_t header = static_cast<size_t>(_cfg.length_offset) + _cfg.length_size;
+    for (;;) {
+        if (_cfg.sync_len && !align_sync()) {
+            return false;
+        }
+        if (_tail - _head < header) {
+            return false;
+        }
+        const uint8_t* lp = _buf.data() + _head + _cfg.length_offset;
+        int32_t value     = lp[0];
+        if (_cfg.length_size == 2) {
+            value = _cfg.length_big_endian ? ((lp[0] << 8) | lp[1]) : ((lp[1] << 8) | lp[0]);
+        }
+        const int32_t total = value + _cfg.length_adjust;
+        if (total < static_cast<int32_t>(header) || total > static_cast<int32_t>(_cfg.max_frame)) {
+            drop(1);  // Broken, resynchronize from the next byte
+            continue;
+        }
+        if (_tail - _head < static_cast<size_t>(total)) {
+            return false;
+        }
+        frame.data = _buf.data() + _head;
+        frame.len  = static_cast<size_t>(total);
+        _head += frame.len;
+        _scan = _head;
+        return true;
+    }
+}
+
+}  // namespace unit
+}  // namespace m5
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*!
+  @file uart_framer.hpp
+  @brief Frame extraction for UART byte streams
+*/
+#ifndef M5_UNIT_COMPONENT_UART_FRAMER_HPP
+#define M5_UNIT_COMPONENT_UART_FRAMER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace m5 {
+namespace unit {
+namespace uart {
+
+//! @brief Framing mode
+enum class FrameMode : uint8_t {
+    Delimiter,     //!< Frames end with the delimiter (e.g. NMEA "\r\n")
+    SyncWord,      //!< Frames begin with the sync word
+    LengthPrefix,  //!< Frames have the length field (optionally after the sync word)
+};
+
+/*!
+  @struct framer_config_t
+  @brief Framer settings
+ */
+struct framer_config_t {
+    FrameMode mode{FrameMode::Delimiter};
+    //! Delimiter (Delimiter)
+    uint8_t delimiter[4]{'\n'};
+    uint8_t delimiter_len{1};
+    //! Include the delimiter in the frame? (Delimiter)
+    bool include_delimiter{false};
+    //! Sync word (SyncWord, and optionally LengthPrefix)
+    uint8_t sync[4]{};
+    uint8_t sync_len{};
+    //! Fixed frame size including the sync word (SyncWord). 0: A frame lasts until the next sync word
+    //! @note max_frame is raised to frame_size if smaller
+    uint16_t frame_size{};
+    //! Offset of the length field from the beginning of the frame (LengthPrefix)
+    uint8_t length_offset{};
+    //! Size of the length field, 1 or 2 (LengthPrefix)
+    uint8_t length_size{1};
+    //! Is the length field big-endian? (LengthPrefix)
+    bool length_big_endian{true};
+    //! Frame size = length field value + length_adjust (LengthPrefix)
+    int16_t length_adjust{};
+    //! Maximum frame size. Longer data is discarded to resynchronize
+    uint16_t max_frame{256};
+};
+
+/*!
+  @struct frame_t
+  @brief View of the extracted frame
+  @warning Valid until the next feed/prepare of the framer
+ */
+struct frame_t {
+    const uint8_t* data{};
+    size_t len{};
+};
+
+}  // namespace uart
+
+/*!
+  @class m5::unit::UARTFramer
+  @brief Extracts whole frames from UART byte stream
+  @details Received bytes are appended to the internal buffer (feed, or prepare and commit to receive in place),
+  and next() returns the frames as views into the buffer without copying
+  @code
+  m5::unit::uart::framer_config_t cfg{};  // Delimiter mode, '\n'
+  m5::unit::UARTFramer framer(cfg);
+  m5::unit::uart::frame_t f{};
+  while (adapter->readFrame(framer, f)) {
+      parse(f.data, f.len);
+  }
+  @endcode
+ */
+class UARTFramer {
+public:
+    explicit UARTFramer(const uart::framer_config_t& cfg = uart::framer_config_t{});
+
+    ///@name Settings
+    ///@{
+    //! @brief Gets the settings
+    inline const uart::framer_config_t& config() const
+    {
+        return _cfg;
+    }
+    //! @brief Set the settings (Buffered data and the dropped count are discarded)
+    void config(const uart::framer_config_t& cfg);
+    ///@}
+
+    ///@name Input
+    ///@{
+    /*!
+      @brief Append the received data
+      @return Number of bytes appended
+     */
+    size_t feed(const uint8_t* data, const size_t len);
+    /*!
+      @brief Gets the free space to receive in place
+      @param[out] capacity Size of the free space
+      @return Pointer to the free space
+      @note Call commit with the number of bytes written
+     */
+    uint8_t* prepare(size_t& capacity);
+    //! @brief Commit the bytes written to the space given by prepare
+    void commit(const size_t len);
+    ///@}
+
+    /*!
+      @brief Gets the next frame
+      @param[out] frame View of the frame
+      @return True if a whole frame was extracted
+     */
+    bool next(uart::frame_t& frame);
+
+    //! @brief Discard buffered data
+    void clear();
+    //! @brief Gets the number of buffered bytes not yet framed
+    inline size_t buffered() const
+    {
+        return _tail - _head;
+    }
+    //! @brief Gets the number of bytes discarded to resynchronize
+    inline uint32_t dropped() const
+    {
+        return _dropped;
+    }
+
+protected:
+    bool next_delimiter(uart::frame_t& frame);
+    bool next_sync(uart::frame_t& frame);
+    bool next_length(uart::frame_t& frame);
+    size_t find(const uint8_t* pat, const size_t plen, const size_t from) const;
+    bool align_sync();
+    void drop(const size_t len);
+    void compact();
+
+private:
+    uart::framer_config_t _cfg{};
+    std::vector<uint8_t> _buf{};
+    size_t _head{};  // Beginning of the unframed data
+    size_t _tail{};  // End of the data
+    size_t _scan{};  // Searched up to here
+    uint32_t _dropped{};
+};
+
+}  // namespace unit
+}  // namespace m5
+#endif
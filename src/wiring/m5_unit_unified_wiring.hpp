@@ -597,8 +597,10 @@ namespace detail {
 
 constexpr size_t kI2CBusCacheSize   = 4;
 constexpr size_t kUARTPortCacheSize = 4;
-constexpr size_t kSPIHostCacheSize  = 2;  // SPI2_HOST / SPI3_HOST
+constexpr size_t kSPIHostCacheSize  = 2;     // SPI2_HOST / SPI3_HOST
 constexpr size_t kSPIDevCacheSize   = 4;
+constexpr size_t kSPIMaxTransfer    = 4096;  // max_transfer_sz of the bus (DMA enabled)
+constexpr int kSPIQueueSize         = 4;     // Allows AdapterSPI::setQueueDepth up to this
 
 #if __has_include(<driver/i2c_master.h>)
 struct I2CCacheEntry {
@@ -619,6 +621,7 @@ struct SPIHostEntry {
 
 struct SPIDevEntry {
     uint32_t key;
+    gpio_num_t cs;  // Hardware CS (GPIO_NUM_NC: manual CS)
     spi_device_handle_t handle;
 };
 
@@ -759,11 +762,13 @@ inline uart_port_t ensureUARTPort(const uart_port_t port, const gpio_num_t rx, c
     return cache[count++].port;
 }
 
-//! @brief Get or initialize a SPI device, cached by {host, clock_hz, mode, bit_order}.
-//! @note  spics_io_num is fixed to GPIO_NUM_NC; cs is controlled manually by the unit's adapter.
+//! @brief Get or initialize a SPI device, cached by {host, clock_hz, mode, bit_order, cs}.
+//! @note  If cs is GPIO_NUM_NC, cs is controlled manually by the unit's adapter.
+//!        Otherwise the peripheral drives cs (spics_io_num) with cs_pretrans/cs_posttrans timing.
 inline spi_device_handle_t ensureSPIDevice(const spi_host_device_t host, const gpio_num_t mosi, const gpio_num_t miso,
                                            const gpio_num_t sck, const uint32_t clock_hz, const uint8_t mode,
-                                           const uint8_t bit_order)
+                                           const uint8_t bit_order, const gpio_num_t cs = GPIO_NUM_NC,
+                                           const uint8_t cs_pretrans = 0, const uint8_t cs_posttrans = 0)
 {
     static SPIHostEntry host_cache[kSPIHostCacheSize]{};
     static SPIDevEntry dev_cache[kSPIDevCacheSize]{};
@@ -784,7 +789,7 @@ inline spi_device_handle_t ensureSPIDevice(const spi_host_device_t host, const g
         bc.sclk_io_num     = sck;
         bc.quadwp_io_num   = -1;
         bc.quadhd_io_num   = -1;
-        bc.max_transfer_sz = 4096;
+        bc.max_transfer_sz = kSPIMaxTransfer;
         if (spi_bus_initialize(host, &bc, SPI_DMA_CH_AUTO) != ESP_OK) {
             M5_LIB_LOGE("wiring: spi_bus_initialize failed host=%d", (int)host);
             return nullptr;
@@ -796,7 +801,7 @@ inline spi_device_handle_t ensureSPIDevice(const spi_host_device_t host, const g
                          (static_cast<uint32_t>(clock_hz / 1000U) << 8) | (static_cast<uint32_t>(mode) << 4) |
                          static_cast<uint32_t>(bit_order);
     for (size_t i = 0; i < dev_count; ++i) {
-        if (dev_cache[i].key == key) return dev_cache[i].handle;
+        if (dev_cache[i].key == key && dev_cache[i].cs == cs) return dev_cache[i].handle;
     }
     if (dev_count >= kSPIDevCacheSize) {
         M5_LIB_LOGE("wiring: SPI device cache full (max %zu)", kSPIDevCacheSize);
@@ -805,14 +810,19 @@ inline spi_device_handle_t ensureSPIDevice(const spi_host_device_t host, const g
     spi_device_interface_config_t dc{};
     dc.clock_speed_hz = static_cast<int>(clock_hz);
     dc.mode           = mode;
-    dc.spics_io_num   = GPIO_NUM_NC;  // manual CS control by adapter
-    dc.queue_size     = 1;
+    dc.spics_io_num   = cs;  // GPIO_NUM_NC: manual CS control by adapter
+    dc.queue_size     = kSPIQueueSize;
+    if (cs != GPIO_NUM_NC) {
+        dc.cs_ena_pretrans  = cs_pretrans;  // The driver accepts more than 1 only for half-duplex devices
+        dc.cs_ena_posttrans = cs_posttrans;
+    }
     if (bit_order == 1) dc.flags |= SPI_DEVICE_BIT_LSBFIRST;
     if (spi_bus_add_device(host, &dc, &dev_cache[dev_count].handle) != ESP_OK) {
         M5_LIB_LOGE("wiring: spi_bus_add_device failed host=%d", (int)host);
         return nullptr;
     }
     dev_cache[dev_count].key = key;
+    dev_cache[dev_count].cs  = cs;
     return dev_cache[dev_count++].handle;
 }
 
@@ -842,15 +852,17 @@ inline uart_port_t uartPortHandle(const uart_port_t port, const gpio_num_t rx, c
 }
 
 /*!
-  @brief Get or initialize a SPI device on the given host (cached by {host, clock_hz, mode, bit_order})
+  @brief Get or initialize a SPI device on the given host (cached by {host, clock_hz, mode, bit_order, cs})
   @note  Intended for unit-specific wiring; examples should use addSPI() instead.
-         CS is controlled manually by the unit's adapter (spics_io_num = GPIO_NUM_NC).
+         If cs is GPIO_NUM_NC (default), CS is controlled manually by the unit's adapter.
+         Otherwise the peripheral drives CS; add the unit with hardware_cs = true.
 */
 inline spi_device_handle_t spiDeviceHandle(const spi_host_device_t host, const gpio_num_t mosi, const gpio_num_t miso,
                                            const gpio_num_t sck, const uint32_t clock_hz, const uint8_t mode = 0,
-                                           const uint8_t bit_order = 0)
+                                           const uint8_t bit_order = 0, const gpio_num_t cs = GPIO_NUM_NC,
+                                           const uint8_t cs_pretrans = 0, const uint8_t cs_posttrans = 0)
 {
-    return detail::ensureSPIDevice(host, mosi, miso, sck, clock_hz, mode, bit_order);
+    return detail::ensureSPIDevice(host, mosi, miso, sck, clock_hz, mode, bit_order, cs, cs_pretrans, cs_posttrans);
 }
 
 //
@@ -939,16 +951,25 @@ inline bool addUART(UnitUnified& units, Component& unit, const uint32_t baud = 1
 }
 
 //! @brief Add a unit on the board's shared SD/SPI bus (ESP-IDF native). CS is taken from unit.address().
+//! @note  If hardware_cs is true, the peripheral drives CS instead of the adapter.
 inline bool addSPI(UnitUnified& units, Component& unit, const uint32_t clock_hz, const uint8_t mode = 0,
-                   const uint8_t bit_order = 0)
+                   const uint8_t bit_order = 0, const bool hardware_cs = false)
 {
     const auto pins = spiPins();
-    M5_LIB_LOGI("wiring(ESP-IDF): addSPI sclk=%d miso=%d mosi=%d clock=%u mode=%u bit_order=%u", (int)pins.sclk,
-                (int)pins.miso, (int)pins.mosi, (unsigned)clock_hz, (unsigned)mode, (unsigned)bit_order);
+    M5_LIB_LOGI("wiring(ESP-IDF): addSPI sclk=%d miso=%d mosi=%d clock=%u mode=%u bit_order=%u hw_cs=%u",
+                (int)pins.sclk, (int)pins.miso, (int)pins.mosi, (unsigned)clock_hz, (unsigned)mode,
+                (unsigned)bit_order, (unsigned)hardware_cs);
+    const gpio_num_t cs = hardware_cs ? static_cast<gpio_num_t>(unit.address()) : GPIO_NUM_NC;
     auto dev = spiDeviceHandle(SPI2_HOST, (gpio_num_t)pins.mosi, (gpio_num_t)pins.miso, (gpio_num_t)pins.sclk, clock_hz,
-                               mode, bit_order);
+                               mode, bit_order, cs);
     if (!dev) return false;
-    return units.add(unit, dev);  // cs omitted -> Component::assign uses address() as CS
+    if (!units.add(unit, dev, cs, hardware_cs)) return false;  // cs NC -> Component::assign uses address() as CS
+    // The bus is initialized with SPI_DMA_CH_AUTO, so large transfers can be single DMA transactions
+    auto ad = unit.asAdapter<AdapterSPI>(Adapter::Type::SPI);
+    if (ad && !ad->setDMA(true, detail::kSPIMaxTransfer)) {
+        M5_LIB_LOGW("wiring: SPI DMA mode unavailable, fallback to FIFO transfer");
+    }
+    return true;
 }
 
 //! @brief Add a unit on the board's Hat I2C header (NessoN1 uses Wire1, others Wire) (ESP-IDF native)
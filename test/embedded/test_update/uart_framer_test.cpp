@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: 2025 M5Stack Technology CO LTD
+ *
+ * SPDX-License-Identifier: MIT
+ */
+/*
+  UnitTest for UARTFramer
+*/
+#include <gtest/gtest.h>
+#include <M5UnitComponent.hpp>
+#include <string>
+
+using namespace m5::unit::uart;
+
+TEST(UARTFramer, Delimiter)
+{
+    m5::unit::UARTFramer framer{};
+    frame_t f{};
+
+    // Delimiter, split across feeds
+    framer_config_t cfg{};
+    cfg.delimiter[0]  = '\r';
+    cfg.delimiter[1]  = '\n';
+    cfg.delimiter_len = 2;
+    framer.config(cfg);
+    EXPECT_EQ(framer.feed((const uint8_t*)"$GPGGA,1\r", 9), 9U);
+    EXPECT_FALSE(framer.next(f));
+    framer.feed((const uint8_t*)"\n$GP", 4);
+    ASSERT_TRUE(framer.next(f));
+    EXPECT_EQ(std::string((const char*)f.data, f.len), "$GPGGA,1");
+    EXPECT_FALSE(framer.next(f));
+    EXPECT_EQ(framer.buffered(), 3U);
+}
+
+TEST(UARTFramer, SyncWord)
+{
+    m5::unit::UARTFramer framer{};
+    frame_t f{};
+
+    // Sync word and fixed size, garbage is dropped
+    framer_config_t cfg{};
+    cfg.mode       = FrameMode::SyncWord;
+    cfg.sync[0]    = 0x59;
+    cfg.sync[1]    = 0x59;
+    cfg.sync_len   = 2;
+    cfg.frame_size = 4;
+    framer.config(cfg);
+    const uint8_t in[] = {0x00, 0x59, 0x59, 0x59, 0x01, 0x02, 0x59, 0x59, 0x03};
+    framer.feed(in, sizeof(in));
+    ASSERT_TRUE(framer.next(f));
+    EXPECT_EQ(f.len, 4U);
+    EXPECT_EQ(f.data[2], 0x59);
+    EXPECT_EQ(f.data[3], 0x01);
+    EXPECT_FALSE(framer.next(f));
+    EXPECT_EQ(framer.dropped(), 2U);  // 0x00 and 0x02
+}
+
+TEST(UARTFramer, SyncWordLargeFrame)
+{
+    m5::unit::UARTFramer framer{};
+    frame_t f{};
+
+    // Fixed size larger than the buffer for max_frame
+    framer_config_t cfg{};
+    cfg.mode       = FrameMode::SyncWord;
+    cfg.sync[0]    = 0xA5;
+    cfg.sync_len   = 1;
+    cfg.frame_size = 100;
+    cfg.max_frame  = 16;
+    framer.config(cfg);
+    EXPECT_EQ(framer.config().max_frame, 100U);
+
+    uint8_t in[100]{};
+    for (uint8_t i = 0; i < sizeof(in); ++i) {
+        in[i] = i ? i : 0xA5;
+    }
+    for (size_t off = 0; off < sizeof(in); off += 10) {
+        EXPECT_FALSE(framer.next(f));
+        EXPECT_EQ(framer.feed(in + off, 10), 10U);
+    }
+    ASSERT_TRUE(framer.next(f));
+    EXPECT_EQ(f.len, 100U);
+    EXPECT_EQ(f.data[0], 0xA5);
+    EXPECT_EQ(f.data[99], 99);
+    EXPECT_EQ(framer.dropped(), 0U);
+}
+
+TEST(UARTFramer, LengthPrefix)
+{
+    m5::unit::UARTFramer framer{};
+    frame_t f{};
+
+    // Length prefix after the sync word, broken length resynchronizes
+    framer_config_t cfg{};
+    cfg.mode          = FrameMode::LengthPrefix;
+    cfg.sync[0]       = 0xAA;
+    cfg.sync_len      = 1;
+    cfg.length_offset = 1;
+    cfg.length_adjust = 2;  // sync + length
+    cfg.max_frame     = 16;
+    framer.config(cfg);
+    const uint8_t in[] = {0xAA, 0xFF, 0xAA, 0x02, 0x10, 0x20, 0xAA, 0x00};
+    framer.feed(in, sizeof(in));
+    ASSERT_TRUE(framer.next(f));
+    EXPECT_EQ(f.len, 4U);
+    EXPECT_EQ(f.data[2], 0x10);
+    EXPECT_EQ(f.data[3], 0x20);
+    ASSERT_TRUE(framer.next(f));
+    EXPECT_EQ(f.len, 2U);
+    EXPECT_FALSE(framer.next(f));
+}
@@ -8,7 +8,177 @@
 */
 #include <gtest/gtest.h>
 #include <M5UnitComponent.hpp>
+#include <M5UnitUnified.hpp>
 #include "unit_dummy.hpp"
+#include <esp_timer.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <atomic>
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_rom_sys.h>
+#endif
+
+namespace {
+
+// Calls issued to the stub impl, e.g. "W8:56/0 S" (register 0x56, no data, stop)
+struct call_log_t {
+    void write(const char* type, const uint32_t reg, const size_t len, const uint32_t exparam)
+    {
+        char buf[32]{};
+        snprintf(buf, sizeof(buf), "%s:%x/%zu %s", type, (unsigned)reg, len, exparam ? "S" : "Sr");
+        calls.emplace_back(buf);
+    }
+    void read(const size_t len)
+    {
+        calls.emplace_back("R/" + std::to_string(len));
+    }
+    std::vector<std::string> calls{};
+};
+
+// I2C device without the bus, does not respond at fail_clock and above
+class StubI2CImpl : public m5::unit::AdapterI2C::I2CImpl {
+public:
+    explicit StubI2CImpl(const uint32_t fail) : I2CImpl(m5::unit::DUMMY_I2C_ADDR, 100000U), fail_clock{fail}
+    {
+    }
+    virtual m5::hal::error::error_t wakeup() override
+    {
+        return clock() < fail_clock ? m5::hal::error::error_t::OK : m5::hal::error::error_t::I2C_BUS_ERROR;
+    }
+    virtual m5::hal::error::error_t readWithTransaction(uint8_t*, const size_t len) override
+    {
+        log.read(len);
+        return wakeup();
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint8_t*, const size_t len,
+                                                         const uint32_t stop) override
+    {
+        log.write("W", 0, len, stop);
+        return wakeup();
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t*, const size_t len,
+                                                         const uint32_t stop) override
+    {
+        log.write("W8", reg, len, stop);
+        return wakeup();
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t*, const size_t len,
+                                                         const uint32_t stop) override
+    {
+        log.write("W16", reg, len, stop);
+        return wakeup();
+    }
+    uint32_t fail_clock{};
+    call_log_t log{};
+};
+
+class StubAdapterI2C : public m5::unit::AdapterI2C {
+public:
+    explicit StubAdapterI2C(const uint32_t fail_clock) : AdapterI2C()
+    {
+        _impl.reset(new StubI2CImpl(fail_clock));
+    }
+    inline StubI2CImpl* stub()
+    {
+        return static_cast<StubI2CImpl*>(_impl.get());
+    }
+};
+
+// SPI device without the bus, shifts out the previously received byte (8-bit shift register)
+class StubSPIImpl : public m5::unit::AdapterSPI::SPIImpl {
+public:
+    virtual m5::hal::error::error_t transferWithTransaction(const uint8_t* tx, uint8_t* rx, const size_t len) override
+    {
+        if (!len || (!tx && !rx)) {
+            return m5::hal::error::error_t::INVALID_ARGUMENT;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            const uint8_t in = tx ? tx[i] : 0xFF;  // MOSI idles high
+            if (rx) {
+                rx[i] = shift;
+            }
+            shift = in;
+        }
+        ++transfers;
+        return m5::hal::error::error_t::OK;
+    }
+    virtual m5::hal::error::error_t readWithTransaction(uint8_t*, const size_t len) override
+    {
+        log.read(len);
+        return m5::hal::error::error_t::OK;
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint8_t*, const size_t len,
+                                                         const uint32_t exparam) override
+    {
+        log.write("W", 0, len, exparam);
+        return m5::hal::error::error_t::OK;
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint8_t reg, const uint8_t*, const size_t len,
+                                                         const uint32_t exparam) override
+    {
+        log.write("W8", reg, len, exparam);
+        return m5::hal::error::error_t::OK;
+    }
+    virtual m5::hal::error::error_t writeWithTransaction(const uint16_t reg, const uint8_t*, const size_t len,
+                                                         const uint32_t exparam) override
+    {
+        log.write("W16", reg, len, exparam);
+        return m5::hal::error::error_t::OK;
+    }
+    uint8_t shift{0xA5};
+    uint32_t transfers{};
+    call_log_t log{};
+};
+
+class StubAdapterSPI : public m5::unit::AdapterSPI {
+public:
+    StubAdapterSPI() : AdapterSPI()
+    {
+        _impl.reset(new StubSPIImpl());
+    }
+    inline StubSPIImpl* stub()
+    {
+        return static_cast<StubSPIImpl*>(_impl.get());
+    }
+};
+
+// Hub that hands the stub adapter to its child in place of the bus
+class UnitStubHub : public m5::unit::UnitDummy {
+public:
+    explicit UnitStubHub(std::shared_ptr<m5::unit::Adapter> adapter) : _stub{adapter}
+    {
+        auto cfg         = component_config();
+        cfg.max_children = 1;
+        component_config(cfg);
+    }
+    using UnitDummy::assign;
+    virtual bool assign(const int8_t, const int8_t) override
+    {
+        return true;
+    }
+
+    uint32_t selected{};  // Number of the channel selections
+
+protected:
+    virtual std::shared_ptr<m5::unit::Adapter> ensure_adapter(const uint8_t) override
+    {
+        return _stub;
+    }
+    virtual m5::hal::error::error_t select_channel(const uint8_t) override
+    {
+        ++selected;
+        return m5::hal::error::error_t::OK;
+    }
+
+private:
+    std::shared_ptr<m5::unit::Adapter> _stub{};
+};
+
+}  // namespace
 
 TEST(Component, Children)
 {
@@ -116,3 +286,382 @@ TEST(Component, DefaultProperties)
     // deviceName
     EXPECT_STREQ(u.deviceName(), "UnitDummy");
 }
+
+TEST(Component, ClockNegotiation)
+{
+    m5::unit::UnitDummy u;
+
+    // opt-in
+    auto cfg = u.component_config();
+    EXPECT_FALSE(cfg.negotiate_clock);
+    EXPECT_EQ(cfg.max_clock, 1000000U);
+
+    // Not assigned to I2C
+    EXPECT_EQ(u.currentClock(), 0U);
+    EXPECT_FALSE(u.negotiateClock());
+}
+
+TEST(Component, ClockNegotiationStub)
+{
+    auto ad = std::make_shared<StubAdapterI2C>(1000000U);  // Fails at 1 MHz
+    UnitStubHub hub(ad);
+    m5::unit::UnitDummy u;
+    m5::unit::UnitUnified units;
+    ASSERT_TRUE(hub.add(u, 0));
+    ASSERT_TRUE(units.add(hub, -1, -1));
+    ASSERT_EQ(u.adapter(), ad.get());
+    uint8_t v{};
+
+    // 1 MHz fails, settles on 400 kHz
+    EXPECT_TRUE(u.negotiateClock());
+    EXPECT_EQ(u.currentClock(), 400000U);
+
+    // Limited by max_clock
+    auto cfg      = u.component_config();
+    cfg.max_clock = 400000U;
+    u.component_config(cfg);
+    ad->stub()->fail_clock = 0xFFFFFFFFU;
+    EXPECT_TRUE(u.negotiateClock());
+    EXPECT_EQ(u.currentClock(), 400000U);
+    cfg.max_clock = 1000000U;
+    u.component_config(cfg);
+
+    // Nothing passes, falls back to the configured clock
+    ad->stub()->fail_clock = 400000U;
+    EXPECT_TRUE(u.negotiateClock());
+    EXPECT_EQ(u.currentClock(), cfg.clock);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_EQ(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    ad->stub()->fail_clock = 0;
+    EXPECT_FALSE(u.negotiateClock());
+    EXPECT_EQ(u.currentClock(), cfg.clock);
+
+    // Step down 1 MHz -> 400 kHz -> configured clock on the runtime errors
+    ad->stub()->fail_clock = 0xFFFFFFFFU;
+    EXPECT_TRUE(u.negotiateClock());
+    EXPECT_EQ(u.currentClock(), 1000000U);
+
+    // Sporadic errors within the window are tolerated
+    ad->stub()->fail_clock = 1000000U;
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_NE(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    ad->stub()->fail_clock = 0xFFFFFFFFU;
+    for (int i = 0; i < 30; ++i) {
+        EXPECT_EQ(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    ad->stub()->fail_clock = 1000000U;
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_NE(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    EXPECT_EQ(u.currentClock(), 1000000U);
+
+    EXPECT_NE(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    EXPECT_EQ(u.currentClock(), 400000U);
+    EXPECT_EQ(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+
+    ad->stub()->fail_clock = 400000U;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NE(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    EXPECT_EQ(u.currentClock(), cfg.clock);
+
+    // No longer monitored at the configured clock
+    ad->stub()->fail_clock = 0;
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_NE(u.readWithTransaction(&v, 1), m5::hal::error::error_t::OK);
+    }
+    EXPECT_EQ(u.currentClock(), cfg.clock);
+}
+
+TEST(Component, TransactionBuilder)
+{
+    using m5::unit::transaction::OpType;
+
+    uint8_t cmd[2]{0x12, 0x34};
+    uint8_t rbuf[4]{};
+    m5::unit::TransactionBuilder tb;
+    EXPECT_TRUE(tb.empty());
+
+    tb.write(cmd, sizeof(cmd))
+        .delay(10)
+        .writeRegister((uint8_t)0x56)
+        .repeatedStart()
+        .read(rbuf, sizeof(rbuf))
+        .writeRegister((uint16_t)0x789A, cmd, 1, false);
+    ASSERT_EQ(tb.size(), 5U);
+
+    auto ops = tb.data();
+    EXPECT_EQ(ops[0].type, OpType::Write);
+    EXPECT_EQ(ops[0].tx, cmd);
+    EXPECT_EQ(ops[0].len, 2U);
+    EXPECT_TRUE(ops[0].stop);
+    EXPECT_EQ(ops[1].type, OpType::Delay);
+    EXPECT_EQ(ops[1].delay_ms, 10U);
+    EXPECT_EQ(ops[2].type, OpType::WriteReg8);
+    EXPECT_EQ(ops[2].reg, 0x56);
+    EXPECT_FALSE(ops[2].stop);  // repeatedStart
+    EXPECT_EQ(ops[3].type, OpType::Read);
+    EXPECT_EQ(ops[3].rx, rbuf);
+    EXPECT_EQ(ops[3].len, 4U);
+    EXPECT_EQ(ops[4].type, OpType::WriteReg16);
+    EXPECT_EQ(ops[4].reg, 0x789A);
+    EXPECT_FALSE(ops[4].stop);
+
+    // repeatedStart affects only the write
+    tb.read(rbuf, 1).repeatedStart();
+    EXPECT_EQ(tb.size(), 6U);
+
+    // Not assigned
+    m5::unit::UnitDummy u;
+    EXPECT_NE(u.executeTransaction(tb), m5::hal::error::error_t::OK);
+
+    tb.clear();
+    EXPECT_TRUE(tb.empty());
+    EXPECT_EQ(u.executeTransaction(tb), m5::hal::error::error_t::OK);
+
+    // Register read with repeated START between write and read
+    tb.write(cmd, sizeof(cmd)).delay(1).writeRegister((uint8_t)0x56).repeatedStart().read(rbuf, sizeof(rbuf));
+    tb.writeRegister((uint16_t)0x789A, cmd, 1);
+
+    // I2C passes STOP/repeated START to the writes, in order with one channel selection
+    {
+        auto ad = std::make_shared<StubAdapterI2C>(0xFFFFFFFFU);
+        UnitStubHub hub(ad);
+        m5::unit::UnitDummy ui;
+        m5::unit::UnitUnified units;
+        ASSERT_TRUE(hub.add(ui, 0));
+        ASSERT_TRUE(units.add(hub, -1, -1));
+
+        EXPECT_EQ(ui.executeTransaction(tb), m5::hal::error::error_t::OK);
+        const std::vector<std::string> expected{"W:0/2 S", "W8:56/0 Sr", "R/4", "W16:789a/1 S"};
+        EXPECT_EQ(ad->stub()->log.calls, expected);
+        EXPECT_EQ(hub.selected, 1U);
+
+        // Stops at the failed op
+        ad->stub()->log.calls.clear();
+        ad->stub()->fail_clock = 0;
+        EXPECT_NE(ui.executeTransaction(tb), m5::hal::error::error_t::OK);
+        EXPECT_EQ(ad->stub()->log.calls.size(), 1U);
+        EXPECT_EQ(hub.selected, 2U);
+    }
+    // Other buses do not support repeated START, and the default exparam is passed to the writes
+    {
+        auto ad = std::make_shared<StubAdapterSPI>();
+        UnitStubHub hub(ad);
+        m5::unit::UnitDummySPI us;
+        m5::unit::UnitUnified units;
+        ASSERT_TRUE(hub.add(us, 0));
+        ASSERT_TRUE(units.add(hub, -1, -1));
+
+        EXPECT_EQ(us.executeTransaction(tb), m5::hal::error::error_t::NOT_IMPLEMENTED);
+        EXPECT_TRUE(ad->stub()->log.calls.empty());
+
+        m5::unit::TransactionBuilder spi;
+        spi.write(cmd, sizeof(cmd), false).read(rbuf, 2);
+        EXPECT_EQ(us.executeTransaction(spi), m5::hal::error::error_t::NOT_IMPLEMENTED);
+        spi.clear();
+        spi.writeRegister((uint8_t)0x12, cmd, 2).read(rbuf, 2).write(cmd, 1);
+        EXPECT_EQ(us.executeTransaction(spi), m5::hal::error::error_t::OK);
+        const std::vector<std::string> expected{"W8:12/2 S", "R/2", "W:0/1 S"};
+        EXPECT_EQ(ad->stub()->log.calls, expected);
+        EXPECT_EQ(hub.selected, 3U);
+    }
+}
+
+TEST(Component, BusLock)
+{
+    using m5::unit::BusLock;
+    using m5::unit::bus_lock_stats_t;
+
+    EXPECT_EQ(bus_lock_stats_t::bucket(0), 0U);
+    EXPECT_EQ(bus_lock_stats_t::bucket(1), 1U);
+    EXPECT_EQ(bus_lock_stats_t::bucket(3), 2U);
+    EXPECT_EQ(bus_lock_stats_t::bucket(4), 3U);
+    EXPECT_EQ(bus_lock_stats_t::bucket(0xFFFFFFFF), bus_lock_stats_t::BUCKETS - 1);
+
+    static uint8_t key{};
+    EXPECT_EQ(BusLock::get(nullptr), nullptr);
+    auto bl = BusLock::get(&key);
+    ASSERT_NE(bl, nullptr);
+    EXPECT_EQ(BusLock::get(&key), bl);
+    bl->resetStats();
+
+    {
+        m5::unit::bus_lock_guard g0(bl);
+        m5::unit::bus_lock_guard g1(bl);  // Nested
+    }
+    auto s = bl->stats();
+    EXPECT_EQ(s.acquired, 1U);
+    EXPECT_EQ(s.contended, 0U);
+
+    // Not shared
+    m5::unit::UnitDummy u;
+    bus_lock_stats_t st{};
+    EXPECT_EQ(u.adapter()->busLock(), nullptr);
+    EXPECT_FALSE(u.adapter()->busLockStats(st));
+}
+
+#if defined(ESP_PLATFORM)
+TEST(Component, BusLockContention)
+{
+    using m5::unit::BusLock;
+    using m5::unit::bus_lock_stats_t;
+
+    struct context_t {
+        BusLock* bl{};
+        std::atomic<int> inside{};
+        std::atomic<bool> overlapped{};
+        std::atomic<int> finished{};
+    };
+    constexpr uint32_t loops{200};
+    constexpr uint32_t hold_us{300};
+
+    static uint8_t key{};
+    context_t ctx{};
+    ctx.bl = BusLock::get(&key);
+    ASSERT_NE(ctx.bl, nullptr);
+    ctx.bl->resetStats();
+
+    // Two tasks (on the both cores if available) hammer the same lock
+    auto task = [](void* arg) {
+        auto c = static_cast<context_t*>(arg);
+        for (uint32_t i = 0; i < loops; ++i) {
+            {
+                m5::unit::bus_lock_guard lock(c->bl);
+                if (++c->inside != 1) {
+                    c->overlapped = true;
+                }
+                esp_rom_delay_us(hold_us);
+                --c->inside;
+            }
+            taskYIELD();
+        }
+        ++c->finished;
+        vTaskDelete(nullptr);
+    };
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(xTaskCreatePinnedToCore(task, "bl", 4096, &ctx, 1, nullptr, i % portNUM_PROCESSORS), pdPASS);
+    }
+    while (ctx.finished < 2) {
+        vTaskDelay(10);
+    }
+
+    // Mutual exclusion
+    EXPECT_FALSE(ctx.overlapped);
+
+    auto s = ctx.bl->stats();
+    EXPECT_EQ(s.acquired, loops * 2);
+    EXPECT_GT(s.contended, 0U);
+    EXPECT_LE(s.blocked, s.contended);
+    EXPECT_GE(s.max_hold_us, hold_us);
+
+    // Every acquisition is in the histograms, and the contended ones waited
+    uint32_t waits{}, waited{}, holds{};
+    for (uint8_t i = 0; i < bus_lock_stats_t::BUCKETS; ++i) {
+        waits += s.wait_histogram[i];
+        waited += i ? s.wait_histogram[i] : 0;
+        holds += s.hold_histogram[i];
+    }
+    EXPECT_EQ(waits, s.acquired);
+    EXPECT_EQ(holds, s.acquired);
+    EXPECT_GT(waited, 0U);
+    EXPECT_GE(s.max_wait_us, hold_us / 2);  // Waited for the most part of the hold at least once
+}
+#endif
+
+TEST(Component, TransferWithTransaction)
+{
+    m5::unit::UnitDummy u;
+    uint8_t tx[2]{0x12, 0x34}, rx[2]{};
+
+    // Not assigned
+    EXPECT_EQ(u.transferWithTransaction(nullptr, nullptr, 2), m5::hal::error::error_t::INVALID_ARGUMENT);
+    EXPECT_EQ(u.transferWithTransaction(tx, rx, 0), m5::hal::error::error_t::INVALID_ARGUMENT);
+    EXPECT_NE(u.transferWithTransaction(tx, rx, 2), m5::hal::error::error_t::OK);
+
+    // Full-duplex on the stub SPI device
+    {
+        auto ad = std::make_shared<StubAdapterSPI>();
+        UnitStubHub hub(ad);
+        m5::unit::UnitDummySPI us;
+        m5::unit::UnitUnified units;
+        ASSERT_TRUE(hub.add(us, 0));
+        ASSERT_TRUE(units.add(hub, -1, -1));
+
+        const uint8_t tx4[4]{0x01, 0x02, 0x03, 0x04};
+        uint8_t rx4[4]{};
+        EXPECT_EQ(us.transferWithTransaction(tx4, rx4, 4), m5::hal::error::error_t::OK);
+        EXPECT_EQ(rx4[0], 0xA5);  // Shifted out while the first byte is shifted in
+        EXPECT_EQ(rx4[1], 0x01);
+        EXPECT_EQ(rx4[2], 0x02);
+        EXPECT_EQ(rx4[3], 0x03);
+        EXPECT_EQ(ad->stub()->shift, 0x04);
+
+        // In-place (tx == rx)
+        uint8_t buf[2]{0x10, 0x20};
+        EXPECT_EQ(us.transferWithTransaction(buf, buf, 2), m5::hal::error::error_t::OK);
+        EXPECT_EQ(buf[0], 0x04);
+        EXPECT_EQ(buf[1], 0x10);
+
+        // One direction only
+        EXPECT_EQ(us.transferWithTransaction(tx4, nullptr, 1), m5::hal::error::error_t::OK);
+        EXPECT_EQ(us.transferWithTransaction(nullptr, rx4, 1), m5::hal::error::error_t::OK);
+        EXPECT_EQ(rx4[0], 0x01);
+        EXPECT_EQ(ad->stub()->shift, 0xFF);
+        EXPECT_EQ(ad->stub()->transfers, 4U);
+    }
+    // Half-duplex only by default (I2C)
+    {
+        auto ad = std::make_shared<StubAdapterI2C>(0xFFFFFFFFU);
+        UnitStubHub hub(ad);
+        m5::unit::UnitDummy ui;
+        m5::unit::UnitUnified units;
+        ASSERT_TRUE(hub.add(ui, 0));
+        ASSERT_TRUE(units.add(hub, -1, -1));
+
+        EXPECT_EQ(ui.transferWithTransaction(nullptr, rx, 2), m5::hal::error::error_t::OK);
+        EXPECT_NE(ui.transferWithTransaction(tx, rx, 2), m5::hal::error::error_t::OK);
+    }
+}
+
+#if defined(M5_UNIT_UNIFIED_USING_ADC_ONESHOT) && (defined(CONFIG_IDF_TARGET_ESP32) || defined(CONFIG_IDF_TARGET_ESP32S3))
+TEST(Component, ADCResident)
+{
+    // RX on ADC1, TX on ADC2
+#if defined(CONFIG_IDF_TARGET_ESP32)
+    m5::unit::AdapterGPIO adapter(36, 4);
+#else
+    m5::unit::AdapterGPIO adapter(1, 11);
+#endif
+    constexpr uint32_t loops{100};
+    uint16_t v{};
+    uint32_t mv{};
+
+    // First reads initialize the units and the calibrations (the cost paid on every unit change before)
+    auto start = esp_timer_get_time();
+    EXPECT_EQ(adapter.readAnalogMilliVoltsRX(mv), m5::hal::error::error_t::OK);
+    EXPECT_EQ(adapter.readAnalogMilliVoltsTX(mv), m5::hal::error::error_t::OK);
+    const int64_t cold = (esp_timer_get_time() - start) / 2;
+
+    // Alternating ADC1 and ADC2 on resident handles
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < loops; ++i) {
+        EXPECT_EQ(adapter.readAnalogRX(v), m5::hal::error::error_t::OK);
+        EXPECT_EQ(adapter.readAnalogTX(v), m5::hal::error::error_t::OK);
+    }
+    const int64_t raw = (esp_timer_get_time() - start) / (loops * 2);
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < loops; ++i) {
+        EXPECT_EQ(adapter.readAnalogMilliVoltsRX(mv), m5::hal::error::error_t::OK);
+        EXPECT_EQ(adapter.readAnalogMilliVoltsTX(mv), m5::hal::error::error_t::OK);
+    }
+    const int64_t cali = (esp_timer_get_time() - start) / (loops * 2);
+
+    M5_LOGI("ADC read latency(us) cold:%lld raw:%lld mv:%lld", cold, raw, cali);
+    EXPECT_LT(raw, cold);
+    EXPECT_LT(cali, cold);
+}
+#endif